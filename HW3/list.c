@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <pthread.h>
 #include "list.h"
+#include "stats.h"
 
 void List_Init(list_t* L) {
     L->head = NULL; /*set head to null*/
@@ -14,26 +15,30 @@ void List_Insert(list_t *L, int key) {
         perror("malloc failure"); /*error*/
         return; /*exit*/
     }
+    Stats_Count(STAT_MALLOC);
     new->key = key;
     
-    pthread_mutex_lock(&L->lock); /*lock critical section*/
+    uint64_t held = Stats_Lock(&L->lock); /*lock critical section*/
     new->next = L->head; /*insert at the front of list*/
     L->head = new; 
-    pthread_mutex_unlock(&L->lock); /*unlock critical section*/
+    Stats_Unlock(&L->lock, held); /*unlock critical section*/
 }
 
 int List_Lookup(list_t *L, int key) {
     int rv = 0; /*zero for failure*/
-    pthread_mutex_lock(&L->lock); /*lock critical section*/
+    uint64_t visited = 0; /*traversal length*/
+    uint64_t held = Stats_Lock(&L->lock); /*lock critical section*/
     node_t *curr = L->head;
     while (curr) {
+        visited++;
         if (curr->key == key) {
              rv = 1; /*one for success*/
              break;
         }
         curr = curr->next;
      }
-    pthread_mutex_unlock(&L->lock); /*unlock critical section*/
+    Stats_Unlock(&L->lock, held); /*unlock critical section*/
+    Stats_Traversal(visited);
     return rv; 
 }
 
@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "list_fc.h"
+#include "stats.h"
+
+/*
+ * Flat combining: a thread publishes its operation in a slot, and whichever
+ * thread grabs the combiner lock runs every published operation while the
+ * list stays hot in its cache. Everyone else just waits on their own slot.
+ */
+
+enum { FC_NONE, FC_INSERT, FC_LOOKUP };
+
+_Static_assert(sizeof(fc_slot_t) == 64, "slot should fill one cache line");
+
+static _Atomic int fc_thread_count = 0;
+static _Thread_local int fc_thread_id = -1; /*home slot hint*/
+
+void List_FC_Init(list_fc_t* L) {
+    L->head = NULL;
+    atomic_init(&L->combining, 0);
+    for(int i = 0; i < FC_SLOTS; i++) {
+        atomic_init(&L->slots[i].busy, 0);
+        atomic_init(&L->slots[i].op, FC_NONE);
+    }
+}
+
+static fc_slot_t* fc_claim(list_fc_t *L) { /*probe from the home slot for a free one*/
+    if(fc_thread_id < 0) {
+        fc_thread_id = atomic_fetch_add(&fc_thread_count, 1);
+    }
+    for(int i = fc_thread_id; ; i++) {
+        fc_slot_t* slot = &L->slots[i % FC_SLOTS];
+        int expected = 0;
+        if(atomic_load_explicit(&slot->busy, memory_order_relaxed) == 0 &&
+           Stats_CAS(atomic_compare_exchange_weak(&slot->busy, &expected, 1))) {
+            return slot;
+        }
+    }
+}
+
+static void fc_combine(list_fc_t *L) { /*run every pending op; caller holds combining*/
+    for(int i = 0; i < FC_SLOTS; i++) {
+        fc_slot_t* slot = &L->slots[i];
+        int op = atomic_load_explicit(&slot->op, memory_order_acquire);
+        if(op == FC_INSERT) {
+            slot->node->next = L->head; /*insert at the front of list*/
+            L->head = slot->node;
+        } else if(op == FC_LOOKUP) {
+            slot->result = 0;
+            uint64_t visited = 0; /*traversal length*/
+            for(node_t* curr = L->head; curr; curr = curr->next) {
+                visited++;
+                if(curr->key == slot->key) {
+                    slot->result = 1;
+                    break;
+                }
+            }
+            Stats_Traversal(visited);
+        } else {
+            continue;
+        }
+        atomic_store_explicit(&slot->op, FC_NONE, memory_order_release); /*hand result back*/
+    }
+}
+
+static int fc_execute(list_fc_t *L, fc_slot_t* slot, int op) { /*publish op and wait for it*/
+    atomic_store_explicit(&slot->op, op, memory_order_release);
+    while(atomic_load_explicit(&slot->op, memory_order_acquire) != FC_NONE) {
+        if(atomic_load_explicit(&L->combining, memory_order_relaxed) == 0 &&
+           Stats_CAS(atomic_exchange_explicit(&L->combining, 1, memory_order_acquire) == 0)) {
+            fc_combine(L); /*we are the combiner*/
+            atomic_store_explicit(&L->combining, 0, memory_order_release);
+        } else {
+            sched_yield(); /*someone else is combining*/
+        }
+    }
+    int result = slot->result;
+    atomic_store_explicit(&slot->busy, 0, memory_order_release); /*free the slot*/
+    return result;
+}
+
+void List_FC_Insert(list_fc_t *L, int key) {
+    node_t* new = (node_t*)malloc(sizeof(node_t)); /*allocate outside the combiner*/
+    if(new == NULL) {
+        perror("malloc failure");
+        return;
+    }
+    Stats_Count(STAT_MALLOC);
+    new->key = key;
+
+    fc_slot_t* slot = fc_claim(L);
+    slot->node = new;
+    fc_execute(L, slot, FC_INSERT);
+}
+
+int List_FC_Lookup(list_fc_t *L, int key) {
+    fc_slot_t* slot = fc_claim(L);
+    slot->key = key;
+    return fc_execute(L, slot, FC_LOOKUP);
+}
+
+void List_FC_Destroy(list_fc_t *L) {
+    /*destroy everything; no operations may be in flight*/
+    node_t *curr = L->head;
+    while(curr) {
+        node_t *next = curr->next;
+        free(curr);
+        curr = next;
+    }
+    free(L);
+}
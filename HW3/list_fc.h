@@ -0,0 +1,30 @@
+#ifndef LIST_FC
+#define LIST_FC
+
+#include <stdatomic.h>
+#include "list.h"
+
+#define FC_SLOTS 64 /*publication slots; more threads just probe for a free one*/
+
+/*one pending operation, padded to its own cache line*/
+typedef struct fc_slot {
+    _Atomic int busy; /*claimed by a thread for the current operation*/
+    _Atomic int op;   /*FC_NONE once the combiner has run it*/
+    int key;
+    int result;
+    node_t* node;     /*node allocated by the caller for an insert*/
+    char pad[64 - 4 * sizeof(int) - sizeof(node_t*)];
+} fc_slot_t;
+
+typedef struct {
+    node_t* head;
+    _Atomic int combining; /*combiner lock*/
+    fc_slot_t slots[FC_SLOTS];
+} list_fc_t;
+
+void List_FC_Init(list_fc_t* L);
+void List_FC_Insert(list_fc_t *L, int key);
+int List_FC_Lookup(list_fc_t *L, int key);
+void List_FC_Destroy(list_fc_t *L);
+
+#endif
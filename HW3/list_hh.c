@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <pthread.h>
 #include "list_hh.h"
+#include "stats.h"
 
 void List_HH_Init(list_hh_t* L) {
     L->head = NULL;
@@ -14,39 +15,46 @@ void List_HH_Insert(list_hh_t *L, int key) {
         perror("malloc failure");
         return;
     }
+    Stats_Count(STAT_MALLOC);
     new->key = key;
     pthread_mutex_init(&new->lock, NULL);
 
-    pthread_mutex_lock(&L->lock);
+    uint64_t held = Stats_Lock(&L->lock);
     new->next = L->head;
     L->head = new;
-    pthread_mutex_unlock(&L->lock);
+    Stats_Unlock(&L->lock, held);
 }
 
 int List_HH_Lookup(list_hh_t *L, int key) {
-    pthread_mutex_lock(&L->lock);  /*Lock list for safe head access*/
+    uint64_t list_held = Stats_Lock(&L->lock);  /*Lock list for safe head access*/
     node_hh_t* curr = L->head;
+    uint64_t curr_held = 0;  /*sampled hold start of curr's lock*/
 
     if (curr != NULL) {
-        pthread_mutex_lock(&curr->lock);  /*Lock first node*/
+        curr_held = Stats_Lock(&curr->lock);  /*Lock first node*/
     }
-    pthread_mutex_unlock(&L->lock);  /*Unlock list*/
+    Stats_Unlock(&L->lock, list_held);  /*Unlock list*/
 
     int found = 0;
+    uint64_t visited = 0;  /*traversal length*/
     while (curr != NULL) {
+        visited++;
         if (curr->key == key) {
             found = 1;
-            pthread_mutex_unlock(&curr->lock);
+            Stats_Unlock(&curr->lock, curr_held);
             break;
         }
 
         node_hh_t* next = curr->next;
+        uint64_t next_held = 0;
         if (next != NULL) {
-            pthread_mutex_lock(&next->lock);  /*Lock next node*/
+            next_held = Stats_Lock(&next->lock);  /*Lock next node*/
         }
-        pthread_mutex_unlock(&curr->lock);  /*Unlock current node*/
+        Stats_Unlock(&curr->lock, curr_held);  /*Unlock current node*/
         curr = next;
+        curr_held = next_held;
     }
+    Stats_Traversal(visited);
     return found;
 }
 
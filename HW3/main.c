@@ -4,31 +4,38 @@
 #include <time.h>
 #include "list.h"
 #include "list_hh.h"
+#include "list_fc.h"
+#include "stats.h"
 
 #define BORDER print_border() /*prints hash border*/
 
 int Node_Count = 15; /*workload/ num of nodes*/
+int Thread_Count = 16; /*threads for the contention test*/
 list_t* Regular = NULL; /*regular list*/
 list_hh_t* HandOverHand = NULL; /*hand over hand list*/
+list_fc_t* FlatCombining = NULL; /*flat combining list*/
 
 void createLists() { /*create the lists*/
     Regular = (list_t*)malloc(sizeof(list_t));
     HandOverHand = (list_hh_t*)malloc(sizeof(list_hh_t));
-    if(!Regular || !HandOverHand) {perror("malloc failure");}
+    FlatCombining = (list_fc_t*)malloc(sizeof(list_fc_t));
+    if(!Regular || !HandOverHand || !FlatCombining) {perror("malloc failure");}
 
     List_Init(Regular);
     List_HH_Init(HandOverHand);
+    List_FC_Init(FlatCombining);
 }
 
 void destoryLists() { /*create the lists*/
     List_Destroy(Regular);
     List_HH_Destroy(HandOverHand);
+    List_FC_Destroy(FlatCombining);
 }
 
 void* thread_insert(void* arg) {
     struct timespec start, end;
 
-    int list_type = *(int*)arg; /*0 for normal and 1 for handovhand*/
+    int list_type = *(int*)arg; /*0 for normal, 1 for handovhand and 2 for flat combining*/
     switch(list_type) {
          /*insert into regular list*/
         case 0:
@@ -44,6 +51,13 @@ void* thread_insert(void* arg) {
                 List_HH_Insert(HandOverHand, i);
             }
             break;
+        /*insert into flat combining list*/
+        case 2:
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for(int i = 0; i < Node_Count; i++) { 
+                List_FC_Insert(FlatCombining, i);
+            }
+            break;
     }
 
     clock_gettime(CLOCK_MONOTONIC, &end);
@@ -58,7 +72,7 @@ void* thread_insert(void* arg) {
 void* thread_lookup(void* arg) {
     struct timespec start, end;
 
-    int list_type = *(int*)arg; /*0 for normal and 1 for handovhand*/
+    int list_type = *(int*)arg; /*0 for normal, 1 for handovhand and 2 for flat combining*/
     switch(list_type) {
          /*insert into regular list*/
         case 0:
@@ -74,6 +88,13 @@ void* thread_lookup(void* arg) {
                 List_HH_Lookup(HandOverHand, i);
             }
             break;
+        /*lookup in flat combining list*/
+        case 2:
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for(int i = 0; i < Node_Count; i++) { 
+                List_FC_Lookup(FlatCombining, i);
+            }
+            break;
     }
 
     clock_gettime(CLOCK_MONOTONIC, &end);
@@ -85,6 +106,51 @@ void* thread_lookup(void* arg) {
     return NULL;
 }
 
+void* thread_mixed(void* arg) { /*insert then look up, no per-thread printing*/
+    int list_type = *(int*)arg; /*0 for normal and 2 for flat combining*/
+    for(int i = 0; i < Node_Count; i++) {
+        if(list_type == 0) {
+            List_Insert(Regular, i);
+        } else {
+            List_FC_Insert(FlatCombining, i);
+        }
+    }
+    for(int i = 0; i < Node_Count; i++) {
+        if(list_type == 0) {
+            List_Lookup(Regular, i);
+        } else {
+            List_FC_Lookup(FlatCombining, i);
+        }
+    }
+    return NULL;
+}
+
+void test_throughput(int list_type, const char* name) { /*Thread_Count threads on one list*/
+    struct timespec start, end;
+    pthread_t* threads = malloc(sizeof(pthread_t) * Thread_Count);
+    if(!threads) {perror("malloc failure"); return;}
+
+    Stats_Reset(); /*count this run only*/
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < Thread_Count; i++) {
+        pthread_create(&threads[i], NULL, thread_mixed, &list_type);
+    }
+    for(int i = 0; i < Thread_Count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double time_taken = (end.tv_sec - start.tv_sec) + 
+                        (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%s list: %d threads, %f seconds, %.0f ops/sec\n", name, Thread_Count,
+           time_taken, 2.0 * Thread_Count * Node_Count / time_taken);
+    free(threads);
+
+    stats_snapshot_t snap;
+    Stats_Snapshot(&snap);
+    Stats_Print(&snap, name);
+}
+
 void print_border() {
     for(int i=0; i<15; i++) {
         printf("#");
@@ -94,20 +160,25 @@ void print_border() {
 
 int main(int argc, char *argv[]) {
 
-    if(argc == 2) { /*check for node code argument*/
+    if(argc >= 2) { /*check for node code argument*/
         Node_Count = atoi(argv[1]);
     }
+    if(argc >= 3) { /*check for thread count argument*/
+        Thread_Count = atoi(argv[2]);
+    }
 
     createLists();
     
     /*thread array for simplicity*/
-    pthread_t threads[8];
+    pthread_t threads[12];
 
      /*Test insert time for normal list*/
     int* arg0 = malloc(sizeof(int));
     int* arg1 = malloc(sizeof(int));
+    int* arg2 = malloc(sizeof(int));
     *arg0 = 0;
     *arg1 = 1;
+    *arg2 = 2;
 
     BORDER;
 
@@ -126,6 +197,15 @@ int main(int argc, char *argv[]) {
     pthread_join(threads[2], NULL);
     pthread_join(threads[3], NULL);
 
+    BORDER;
+
+     /*Test insert time for flat combining list*/
+    printf("Testing flat combining list insert times for %d nodes:\n", Node_Count);
+    pthread_create(&threads[8], NULL, thread_insert, arg2);
+    pthread_create(&threads[9], NULL, thread_insert, arg2);
+    pthread_join(threads[8], NULL);
+    pthread_join(threads[9], NULL);
+
     BORDER;
 
      /*Test lookup time for normal list*/
@@ -146,6 +226,28 @@ int main(int argc, char *argv[]) {
 
     BORDER;
 
-    free(arg0); free(arg1);
+    /*Test lookup time for flat combining list*/
+    printf("Testing flat combining list lookup times for %d nodes:\n", Node_Count);
+    pthread_create(&threads[10], NULL, thread_lookup, arg2);
+    pthread_create(&threads[11], NULL, thread_lookup, arg2);
+    pthread_join(threads[10], NULL);
+    pthread_join(threads[11], NULL);
+
+    BORDER;
+
+    stats_snapshot_t snap; /*everything above, all lists together*/
+    Stats_Snapshot(&snap);
+    Stats_Print(&snap, "Timing tests");
+
+    /*Test throughput under contention on fresh lists*/
+    destoryLists();
+    createLists();
+    printf("Testing insert+lookup throughput for %d nodes per thread:\n", Node_Count);
+    test_throughput(0, "Regular");
+    test_throughput(2, "Flat combining");
+
+    BORDER;
+
+    free(arg0); free(arg1); free(arg2);
     destoryLists();
 }
\ No newline at end of file
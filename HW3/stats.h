@@ -0,0 +1,157 @@
+#ifndef STATS_H
+#define STATS_H
+
+/*
+ * Contention instrumentation, compiled in with -DCONTENTION_STATS.
+ *
+ * Each thread counts into its own cache-line aligned record, so the hot
+ * paths never share a counter. Lock wait and hold times are only taken for
+ * one in 2^STATS_SAMPLE_SHIFT acquisitions per thread to keep clock reads
+ * off most operations; the acquire and contended counts are exact.
+ * Stats_Snapshot sums every record on demand. Without the flag every hook
+ * below compiles down to the bare operation.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#ifndef STATS_SAMPLE_SHIFT
+#define STATS_SAMPLE_SHIFT 4
+#endif
+
+#define STATS_BUCKETS 32 /*log2 buckets: bucket b holds values in [2^(b-1), 2^b)*/
+
+enum {
+    STAT_LOCK,           /*mutex acquisitions*/
+    STAT_LOCK_CONTENDED, /*acquisitions that found the mutex held*/
+    STAT_CAS,            /*compare-and-swap attempts*/
+    STAT_CAS_FAIL,       /*failed compare-and-swaps*/
+    STAT_TRAVERSAL,      /*list walks*/
+    STAT_TRAVERSAL_NODES,/*nodes visited by those walks*/
+    STAT_MALLOC,         /*node allocations*/
+    STAT_FREE,           /*node frees*/
+    STAT_COUNT
+};
+
+enum {
+    HIST_LOCK_WAIT, /*ns from lock call to acquisition, sampled*/
+    HIST_LOCK_HOLD, /*ns from acquisition to unlock, sampled*/
+    HIST_TRAVERSAL, /*nodes visited per walk*/
+    HIST_COUNT
+};
+
+typedef struct stats_snapshot_t {
+    int threads; /*per-thread records (exited threads hand theirs on)*/
+    uint64_t counters[STAT_COUNT];
+    uint64_t hist[HIST_COUNT][STATS_BUCKETS];
+} stats_snapshot_t;
+
+void Stats_Snapshot(stats_snapshot_t *snap);
+void Stats_Reset(void); /*only while no instrumented operation is running*/
+void Stats_Print(const stats_snapshot_t *snap, const char *label);
+
+#ifdef CONTENTION_STATS
+
+typedef struct stats_thread_t {
+    _Atomic uint64_t counters[STAT_COUNT];
+    _Atomic uint64_t hist[HIST_COUNT][STATS_BUCKETS];
+    uint32_t sample;                /*owner-only sampling tick*/
+    _Atomic int in_use;             /*claimed by a live thread*/
+    struct stats_thread_t *next;    /*registry link*/
+} stats_thread_t;
+
+extern _Thread_local stats_thread_t *Stats_Local;
+stats_thread_t *Stats_Register(void);
+
+static inline stats_thread_t *Stats_Self(void) {
+    stats_thread_t *t = Stats_Local;
+    return t != NULL ? t : Stats_Register();
+}
+
+/*single writer, so a relaxed load/store pair is enough and needs no lock prefix*/
+static inline void stats_add(_Atomic uint64_t *c, uint64_t n) {
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline int stats_bucket(uint64_t v) {
+    int b = v == 0 ? 0 : 64 - __builtin_clzll(v);
+    return b < STATS_BUCKETS ? b : STATS_BUCKETS - 1;
+}
+
+static inline uint64_t stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static inline void Stats_Count(int counter) {
+    stats_add(&Stats_Self()->counters[counter], 1);
+}
+
+/*lock m; returns the acquisition time if this one is sampled, else 0*/
+static inline uint64_t Stats_Lock(pthread_mutex_t *m) {
+    stats_thread_t *t = Stats_Self();
+    stats_add(&t->counters[STAT_LOCK], 1);
+    bool sampled = (++t->sample & ((1u << STATS_SAMPLE_SHIFT) - 1)) == 0;
+    uint64_t start = sampled ? stats_now() : 0;
+    if (pthread_mutex_trylock(m) != 0) {
+        stats_add(&t->counters[STAT_LOCK_CONTENDED], 1);
+        pthread_mutex_lock(m);
+    }
+    if (!sampled) {
+        return 0;
+    }
+    uint64_t acquired = stats_now();
+    stats_add(&t->hist[HIST_LOCK_WAIT][stats_bucket(acquired - start)], 1);
+    return acquired | 1; /*never 0, so a sampled hold is always recorded*/
+}
+
+static inline void Stats_Unlock(pthread_mutex_t *m, uint64_t acquired) {
+    if (acquired != 0) {
+        uint64_t held = stats_now() - acquired;
+        stats_add(&Stats_Self()->hist[HIST_LOCK_HOLD][stats_bucket(held)], 1);
+    }
+    pthread_mutex_unlock(m);
+}
+
+/*record one compare-and-swap outcome; returns it so calls can wrap the CAS*/
+static inline bool Stats_CAS(bool ok) {
+    stats_thread_t *t = Stats_Self();
+    stats_add(&t->counters[STAT_CAS], 1);
+    if (!ok) {
+        stats_add(&t->counters[STAT_CAS_FAIL], 1);
+    }
+    return ok;
+}
+
+static inline void Stats_Traversal(uint64_t nodes) {
+    stats_thread_t *t = Stats_Self();
+    stats_add(&t->counters[STAT_TRAVERSAL], 1);
+    stats_add(&t->counters[STAT_TRAVERSAL_NODES], nodes);
+    stats_add(&t->hist[HIST_TRAVERSAL][stats_bucket(nodes)], 1);
+}
+
+#else
+
+static inline void Stats_Count(int counter) { (void)counter; }
+
+static inline uint64_t Stats_Lock(pthread_mutex_t *m) {
+    pthread_mutex_lock(m);
+    return 0;
+}
+
+static inline void Stats_Unlock(pthread_mutex_t *m, uint64_t acquired) {
+    (void)acquired;
+    pthread_mutex_unlock(m);
+}
+
+static inline bool Stats_CAS(bool ok) { return ok; }
+
+static inline void Stats_Traversal(uint64_t nodes) { (void)nodes; }
+
+#endif
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef EVENTCOUNT_H
+#define EVENTCOUNT_H
+
+/*
+ * Eventcount used to park consumers of an empty queue.
+ *
+ * A consumer calls EC_Prepare, re-checks the queue, then EC_Wait (or
+ * EC_Cancel if it found an item). A producer calls EC_Signal after
+ * publishing an item; it only bumps the sequence and enters the kernel when
+ * waiters are registered, so the uncontended path makes no syscalls.
+ *
+ * On Linux waiters sleep on a futex on the sequence word; elsewhere a
+ * mutex/condition variable pair stands in. Header-only so the queues build
+ * without an extra translation unit.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <pthread.h>
+#endif
+
+typedef struct eventcount_t {
+    _Atomic uint32_t seq;     /*bumped by each signal that finds waiters*/
+    _Atomic uint32_t waiters; /*consumers between prepare and wake*/
+#ifndef __linux__
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} eventcount_t;
+
+static inline void EC_Init(eventcount_t *ec) {
+    atomic_init(&ec->seq, 0);
+    atomic_init(&ec->waiters, 0);
+#ifndef __linux__
+    pthread_mutex_init(&ec->lock, NULL);
+    pthread_cond_init(&ec->cond, NULL);
+#endif
+}
+
+static inline void EC_Destroy(eventcount_t *ec) {
+#ifndef __linux__
+    pthread_mutex_destroy(&ec->lock);
+    pthread_cond_destroy(&ec->cond);
+#else
+    (void)ec;
+#endif
+}
+
+/*register as a waiter; returns the key to pass to EC_Wait*/
+static inline uint32_t EC_Prepare(eventcount_t *ec) {
+    atomic_fetch_add(&ec->waiters, 1);
+    return atomic_load(&ec->seq);
+}
+
+/*deregister without sleeping (the re-check found an item)*/
+static inline void EC_Cancel(eventcount_t *ec) {
+    atomic_fetch_sub(&ec->waiters, 1);
+}
+
+/*deadline for a relative timeout, on the clock EC_Wait uses*/
+static inline struct timespec EC_Deadline(const struct timespec *timeout) {
+    struct timespec now;
+#ifdef __linux__
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    clock_gettime(CLOCK_REALTIME, &now);
+#endif
+    now.tv_sec += timeout->tv_sec;
+    now.tv_nsec += timeout->tv_nsec;
+    if (now.tv_nsec >= 1000000000L) {
+        now.tv_sec++;
+        now.tv_nsec -= 1000000000L;
+    }
+    return now;
+}
+
+/*
+ * Sleep until a signal after EC_Prepare returned key, or until the absolute
+ * deadline (NULL waits forever). Returns false only on timeout. May return
+ * spuriously; callers re-check the queue either way.
+ */
+static inline bool EC_Wait(eventcount_t *ec, uint32_t key, const struct timespec *deadline) {
+    bool timed_out = false;
+#ifdef __linux__
+    /*FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline*/
+    long rc = syscall(SYS_futex, &ec->seq, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+                      key, deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+    timed_out = (rc == -1 && errno == ETIMEDOUT);
+#else
+    pthread_mutex_lock(&ec->lock);
+    while (atomic_load(&ec->seq) == key && !timed_out) {
+        if (deadline == NULL) {
+            pthread_cond_wait(&ec->cond, &ec->lock);
+        } else {
+            timed_out = (pthread_cond_timedwait(&ec->cond, &ec->lock, deadline) == ETIMEDOUT);
+        }
+    }
+    pthread_mutex_unlock(&ec->lock);
+#endif
+    atomic_fetch_sub(&ec->waiters, 1);
+    return !timed_out;
+}
+
+/*wake one waiter if there are any; call after publishing an item*/
+static inline void EC_Signal(eventcount_t *ec) {
+    /*order the publish before the waiter check (pairs with EC_Prepare)*/
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load(&ec->waiters) == 0) {
+        return; /*fast path: nobody parked*/
+    }
+#ifdef __linux__
+    atomic_fetch_add(&ec->seq, 1);
+    syscall(SYS_futex, &ec->seq, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&ec->lock);
+    atomic_fetch_add(&ec->seq, 1);
+    pthread_cond_signal(&ec->cond);
+    pthread_mutex_unlock(&ec->lock);
+#endif
+}
+
+#endif
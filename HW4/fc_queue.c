@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+#include "fc_queue.h"
+#include "stats.h"
+
+// Flat combining: each thread publishes its operation in a slot, and
+// whichever thread grabs the combiner lock runs every published operation
+// while the queue stays hot in its cache. Nodes are allocated and freed by
+// the requesting threads, outside the combiner.
+
+enum { FC_NONE, FC_ENQUEUE, FC_DEQUEUE };
+
+_Static_assert(sizeof(fc_slot_t) == 64, "slot should fill one cache line");
+
+static _Atomic int fc_thread_count = 0;
+static _Thread_local int fc_thread_id = -1;  // Home slot hint
+
+void FC_Queue_Init(fc_queue_t *q) {
+    fc_node_t *tmp = (fc_node_t *)malloc(sizeof(fc_node_t));
+    assert(tmp != NULL);
+    tmp->next = NULL;
+    q->head = q->tail = tmp;
+    atomic_init(&q->combining, 0);
+    for (int i = 0; i < FC_SLOTS; i++) {
+        atomic_init(&q->slots[i].busy, 0);
+        atomic_init(&q->slots[i].op, FC_NONE);
+    }
+}
+
+// Claim a free slot, probing from the thread's home slot
+static fc_slot_t *fc_claim(fc_queue_t *q) {
+    if (fc_thread_id < 0) {
+        fc_thread_id = atomic_fetch_add(&fc_thread_count, 1);
+    }
+    for (int i = fc_thread_id; ; i++) {
+        fc_slot_t *slot = &q->slots[i % FC_SLOTS];
+        int expected = 0;
+        if (atomic_load_explicit(&slot->busy, memory_order_relaxed) == 0 &&
+            Stats_CAS(atomic_compare_exchange_weak(&slot->busy, &expected, 1))) {
+            return slot;
+        }
+    }
+}
+
+// Run every pending operation; caller holds the combiner lock
+static void fc_combine(fc_queue_t *q) {
+    for (int i = 0; i < FC_SLOTS; i++) {
+        fc_slot_t *slot = &q->slots[i];
+        int op = atomic_load_explicit(&slot->op, memory_order_acquire);
+        if (op == FC_ENQUEUE) {
+            q->tail->next = slot->node;
+            q->tail = slot->node;
+        } else if (op == FC_DEQUEUE) {
+            fc_node_t *new_head = q->head->next;
+            slot->ok = (new_head != NULL);
+            if (slot->ok) {
+                slot->value = new_head->value;
+                slot->node = q->head;  // Requester frees the old dummy
+                q->head = new_head;
+            }
+        } else {
+            continue;
+        }
+        atomic_store_explicit(&slot->op, FC_NONE, memory_order_release);  // Hand result back
+    }
+}
+
+// Publish an operation and wait until some combiner (maybe us) has run it
+static void fc_execute(fc_queue_t *q, fc_slot_t *slot, int op) {
+    atomic_store_explicit(&slot->op, op, memory_order_release);
+    while (atomic_load_explicit(&slot->op, memory_order_acquire) != FC_NONE) {
+        if (atomic_load_explicit(&q->combining, memory_order_relaxed) == 0 &&
+            Stats_CAS(atomic_exchange_explicit(&q->combining, 1, memory_order_acquire) == 0)) {
+            fc_combine(q);
+            atomic_store_explicit(&q->combining, 0, memory_order_release);
+        } else {
+            sched_yield();  // Someone else is combining
+        }
+    }
+}
+
+// Enqueue operation
+void FC_Queue_Enqueue(fc_queue_t *q, int value) {
+    fc_node_t *tmp = (fc_node_t *)malloc(sizeof(fc_node_t));
+    assert(tmp != NULL);
+    Stats_Count(STAT_MALLOC);
+    tmp->value = value;
+    tmp->next = NULL;
+
+    fc_slot_t *slot = fc_claim(q);
+    slot->node = tmp;
+    fc_execute(q, slot, FC_ENQUEUE);
+    atomic_store_explicit(&slot->busy, 0, memory_order_release);
+}
+
+// Dequeue operation
+bool FC_Queue_Dequeue(fc_queue_t *q, int *value) {
+    fc_slot_t *slot = fc_claim(q);
+    fc_execute(q, slot, FC_DEQUEUE);
+    bool ok = slot->ok != 0;
+    fc_node_t *old = slot->node;
+    if (ok) {
+        *value = slot->value;
+    }
+    atomic_store_explicit(&slot->busy, 0, memory_order_release);
+
+    if (ok) {
+        free(old);
+        Stats_Count(STAT_FREE);
+    }
+    return ok;
+}
+
+void FC_Queue_Delete(fc_queue_t *q) {
+    if (q == NULL) return; // Null check
+
+    // Traverse and free all nodes; no operations may be in flight
+    fc_node_t *current = q->head;
+    while (current != NULL) {
+        fc_node_t *next = current->next;
+        free(current);
+        current = next;
+    }
+}
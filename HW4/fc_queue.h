@@ -0,0 +1,40 @@
+#ifndef FC_QUEUE_H
+#define FC_QUEUE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#define FC_SLOTS 64 // Publication slots; more threads just probe for a free one
+
+// Node structure
+typedef struct fc_node_t {
+    int value;
+    struct fc_node_t *next;
+} fc_node_t;
+
+// One pending operation, padded to its own cache line
+typedef struct fc_slot_t {
+    _Atomic int busy;  // Claimed by a thread for the current operation
+    _Atomic int op;    // FC_NONE once the combiner has run it
+    int ok;            // Dequeue found an item
+    int value;
+    fc_node_t *node;   // Enqueue: new node; dequeue: old dummy to free
+    char pad[64 - 4 * sizeof(int) - sizeof(fc_node_t *)];
+} fc_slot_t;
+
+// FC_Queue structure
+typedef struct fc_queue_t {
+    fc_node_t *head;
+    fc_node_t *tail;
+    _Atomic int combining;  // Combiner lock
+    fc_slot_t slots[FC_SLOTS];
+} fc_queue_t;
+
+// Function prototypes
+void FC_Queue_Init(fc_queue_t *q);
+void FC_Queue_Enqueue(fc_queue_t *q, int value);
+bool FC_Queue_Dequeue(fc_queue_t *q, int *value); // false if empty
+void FC_Queue_Delete(fc_queue_t *q);
+
+#endif 
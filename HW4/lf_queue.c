@@ -3,6 +3,7 @@
 #include <stdatomic.h>
 #include <assert.h>
 #include "lf_queue.h"
+#include "stats.h"
 
 void LF_Queue_Init(lf_queue_t *q) {
     lf_node_t *tmp = (lf_node_t *)malloc(sizeof(lf_node_t));
@@ -10,6 +11,7 @@ void LF_Queue_Init(lf_queue_t *q) {
     tmp->next = NULL;
     atomic_store(&q->head, tmp);
     atomic_store(&q->tail, tmp);
+    EC_Init(&q->ec);
 }
 
 void LF_Queue_Enqueue(lf_queue_t *q, int value) {
@@ -17,6 +19,7 @@ void LF_Queue_Enqueue(lf_queue_t *q, int value) {
     if (new_node == NULL) {
         return;
     }
+    Stats_Count(STAT_MALLOC);
     new_node->value = value;
     atomic_store(&new_node->next, NULL);  // Proper atomic initialization
 
@@ -25,19 +28,20 @@ void LF_Queue_Enqueue(lf_queue_t *q, int value) {
         lf_node_t *next = atomic_load(&tail->next);
 
         if (next == NULL) {  // Tail is at the last node 
-            if (atomic_compare_exchange_strong(&tail->next, &next, new_node)) {
+            if (Stats_CAS(atomic_compare_exchange_strong(&tail->next, &next, new_node))) {
                 // Successfully added new node now set new tail
-                atomic_compare_exchange_strong(&q->tail, &tail, new_node);
+                Stats_CAS(atomic_compare_exchange_strong(&q->tail, &tail, new_node));
+                EC_Signal(&q->ec); // No syscall unless a consumer is parked
                 return; // Exit loop
             }
         } else {
             // Tail is behind, get updated tail
-            atomic_compare_exchange_strong(&q->tail, &tail, next);
+            Stats_CAS(atomic_compare_exchange_strong(&q->tail, &tail, next));
         }
     }
 }
 
-int LF_Queue_Dequeue(lf_queue_t *q) {
+bool LF_Queue_Dequeue(lf_queue_t *q, int *value) {
     while (1) {
         lf_node_t* head = atomic_load(&q->head);
         lf_node_t* tail = atomic_load(&q->tail);
@@ -45,23 +49,51 @@ int LF_Queue_Dequeue(lf_queue_t *q) {
 
         if (head == tail) {  // Queue might be empty
             if (next == NULL) {  // Confirm empty queue
-                return -1;
+                return false;
             }
             // Tail is lagging, try to advance it
-            atomic_compare_exchange_strong(&q->tail, &tail, next);
+            Stats_CAS(atomic_compare_exchange_strong(&q->tail, &tail, next));
         } else {
             if (next == NULL) {  // Unexpected NULL, should not happen
-                return -1;
+                return false;
             }
-            int value = next->value;
-            if (atomic_compare_exchange_strong(&q->head, &head, next)) {
+            int next_value = next->value;
+            if (Stats_CAS(atomic_compare_exchange_strong(&q->head, &head, next))) {
                 free(head);
-                return value;
+                Stats_Count(STAT_FREE);
+                *value = next_value;
+                return true;
             }
         }
     }
 }
 
+// Blocking dequeue, waits up to timeout (NULL waits forever)
+bool LF_Queue_Dequeue_Timed(lf_queue_t *q, int *value, const struct timespec *timeout) {
+    struct timespec deadline;
+    if (timeout != NULL) {
+        deadline = EC_Deadline(timeout);
+    }
+
+    while (1) {
+        if (LF_Queue_Dequeue(q, value)) {
+            return true;
+        }
+        uint32_t key = EC_Prepare(&q->ec);
+        if (LF_Queue_Dequeue(q, value)) {  // Re-check after registering
+            EC_Cancel(&q->ec);
+            return true;
+        }
+        if (!EC_Wait(&q->ec, key, timeout != NULL ? &deadline : NULL)) {
+            return LF_Queue_Dequeue(q, value);  // Timed out, last look
+        }
+    }
+}
+
+void LF_Queue_Dequeue_Wait(lf_queue_t *q, int *value) {
+    LF_Queue_Dequeue_Timed(q, value, NULL);
+}
+
 void LF_Queue_Delete(lf_queue_t *q) {
     if (q == NULL) return; // Null check
     
@@ -77,6 +109,7 @@ void LF_Queue_Delete(lf_queue_t *q) {
 
     // Mark tail as NULL to signal queue is gone
     atomic_store(&q->tail, NULL);
+    EC_Destroy(&q->ec);
 
     free(q);  // Free the queue structure if it was dynamically allocated
 }
@@ -2,7 +2,11 @@
 #define LF_QUEUE_H
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <stdatomic.h>
+#include <time.h>
+
+#include "eventcount.h"
 
 // Node structure
 typedef struct lf_node_t {
@@ -14,12 +18,15 @@ typedef struct lf_node_t {
 typedef struct lf_queue_t {
     _Atomic(lf_node_t *) head;
     _Atomic(lf_node_t *) tail;
+    eventcount_t ec; /*parks consumers while the queue is empty*/
 } lf_queue_t;
 
 // Function prototypes
 void LF_Queue_Init(lf_queue_t *q);
 void LF_Queue_Enqueue(lf_queue_t *q, int value);
-int LF_Queue_Dequeue(lf_queue_t *q);
+bool LF_Queue_Dequeue(lf_queue_t *q, int *value); /*false if empty*/
+void LF_Queue_Dequeue_Wait(lf_queue_t *q, int *value); /*blocks until an item arrives*/
+bool LF_Queue_Dequeue_Timed(lf_queue_t *q, int *value, const struct timespec *timeout); /*false on timeout*/
 void LF_Queue_Delete(lf_queue_t *q);
 
 #endif 
@@ -1,29 +1,36 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <stdbool.h>
 #include <time.h>
 
 #include "ms_queue.h"
 #include "lf_queue.h"
+#include "fc_queue.h"
+#include "stats.h"
 
 ms_queue_t* MS = NULL; /*Michael and Scott Concurrent Queue*/
 lf_queue_t* LF = NULL; /*lock-free concurrent queue*/
+fc_queue_t* FC = NULL; /*flat combining queue*/
 
 int Item_Count = 15;
+int Thread_Count = 16; /*threads for the contention test*/
 
 void createQueues() { /*create the lists*/
     MS = (ms_queue_t*)malloc(sizeof(ms_queue_t));
     LF = (lf_queue_t*)malloc(sizeof(lf_queue_t));
-    if(!MS || !LF) {perror("malloc failure");}
+    FC = (fc_queue_t*)malloc(sizeof(fc_queue_t));
+    if(!MS || !LF || !FC) {perror("malloc failure");}
 
     MS_Queue_Init(MS);
     LF_Queue_Init(LF);
+    FC_Queue_Init(FC);
 }
 
 void* thread_enqueue(void* arg) {
     struct timespec start, end;
 
-    int queue_type = *(int*)arg; /*0 for mich.scott and 1 for lock free*/
+    int queue_type = *(int*)arg; /*0 for mich.scott, 1 for lock free and 2 for flat combining*/
     switch(queue_type) {
          /*insert into ms queue*/
         case 0:
@@ -39,6 +46,13 @@ void* thread_enqueue(void* arg) {
                 LF_Queue_Enqueue(LF, i);
             }
             break;
+        /*insert into flat combining queue*/
+        case 2:
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for(int i = 0; i < Item_Count; i++) { 
+                FC_Queue_Enqueue(FC, i);
+            }
+            break;
     }
 
     clock_gettime(CLOCK_MONOTONIC, &end);
@@ -53,20 +67,30 @@ void* thread_enqueue(void* arg) {
 void* thread_dequeue(void* arg) {
     struct timespec start, end;
 
-    int queue_type = *(int*)arg; /*0 for mich.scott and 1 for lock free*/
+    int queue_type = *(int*)arg; /*0 for mich.scott, 1 for lock free and 2 for flat combining*/
     switch(queue_type) {
          /*insert into ms queue*/
         case 0:
             clock_gettime(CLOCK_MONOTONIC, &start);
             for(int i = 0; i < Item_Count; i++) {
-                MS_Queue_Dequeue(MS);
+                int value;
+                MS_Queue_Dequeue(MS, &value);
             }
             break;
         /*insert into lock free queue*/
         case 1:
             clock_gettime(CLOCK_MONOTONIC, &start);
             for(int i = 0; i < Item_Count; i++) { 
-                LF_Queue_Dequeue(LF);
+                int value;
+                LF_Queue_Dequeue(LF, &value);
+            }
+            break;
+        /*remove from flat combining queue*/
+        case 2:
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for(int i = 0; i < Item_Count; i++) { 
+                int value;
+                FC_Queue_Dequeue(FC, &value);
             }
             break;
     }
@@ -80,21 +104,107 @@ void* thread_dequeue(void* arg) {
     return NULL;
 }
 
+void* thread_dequeue_wait(void* arg) {
+    struct timespec start, end;
+
+    int queue_type = *(int*)arg; /*0 for mich.scott and 1 for lock free*/
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < Item_Count; i++) {
+        int value;
+        if(queue_type == 0) {
+            MS_Queue_Dequeue_Wait(MS, &value); /*sleeps while empty*/
+        } else {
+            LF_Queue_Dequeue_Wait(LF, &value);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double time_taken = (end.tv_sec - start.tv_sec) + 
+                        (end.tv_nsec - start.tv_nsec) / 1e9;
+    
+    printf("Thread Execution time = %f seconds\n", time_taken);
+
+    return NULL;
+}
+
+void* thread_pairs(void* arg) { /*enqueue/dequeue pairs, no per-thread printing*/
+    int queue_type = *(int*)arg;
+    for(int i = 0; i < Item_Count; i++) {
+        int value;
+        switch(queue_type) {
+            case 0: MS_Queue_Enqueue(MS, i); MS_Queue_Dequeue(MS, &value); break;
+            case 1: LF_Queue_Enqueue(LF, i); LF_Queue_Dequeue(LF, &value); break;
+            case 2: FC_Queue_Enqueue(FC, i); FC_Queue_Dequeue(FC, &value); break;
+        }
+    }
+    return NULL;
+}
+
+void test_throughput(int queue_type, const char* name) { /*Thread_Count threads on one queue*/
+    struct timespec start, end;
+    pthread_t* threads = malloc(sizeof(pthread_t) * Thread_Count);
+    if(!threads) {perror("malloc failure"); return;}
+
+    Stats_Reset(); /*count this run only*/
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int i = 0; i < Thread_Count; i++) {
+        pthread_create(&threads[i], NULL, thread_pairs, &queue_type);
+    }
+    for(int i = 0; i < Thread_Count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double time_taken = (end.tv_sec - start.tv_sec) + 
+                        (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("%s queue: %d threads, %f seconds, %.0f ops/sec\n", name, Thread_Count,
+           time_taken, 2.0 * Thread_Count * Item_Count / time_taken);
+    free(threads);
+
+    stats_snapshot_t snap;
+    Stats_Snapshot(&snap);
+    Stats_Print(&snap, name);
+}
+
+void test_timed_dequeue(int queue_type) { /*time out on an empty queue*/
+    struct timespec start, end;
+    struct timespec timeout = {0, 10 * 1000000}; /*10ms*/
+    int value;
+    bool got;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(queue_type == 0) {
+        got = MS_Queue_Dequeue_Timed(MS, &value, &timeout);
+    } else {
+        got = LF_Queue_Dequeue_Timed(LF, &value, &timeout);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double time_taken = (end.tv_sec - start.tv_sec) + 
+                        (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    printf("Timed dequeue on empty queue returned %s after %f seconds\n", got ? "an item" : "empty", time_taken);
+}
+
 int main(int argc, char *argv[]) {
     createQueues();
 
-    if(argc == 2) { /*check for node code argument*/
+    if(argc >= 2) { /*check for node code argument*/
         Item_Count = atoi(argv[1]);
     }
+    if(argc >= 3) { /*check for thread count argument*/
+        Thread_Count = atoi(argv[2]);
+    }
 
      /*thread array for simplicity*/
-     pthread_t threads[8];
+     pthread_t threads[20];
 
      /*Test insert time for normal list*/
     int* arg0 = malloc(sizeof(int));
     int* arg1 = malloc(sizeof(int));
+    int* arg2 = malloc(sizeof(int));
     *arg0 = 0;
     *arg1 = 1;
+    *arg2 = 2;
 
 
     printf("Testing Michael and Scott queue enqueue times for %d items:\n", Item_Count);
@@ -109,6 +219,12 @@ int main(int argc, char *argv[]) {
     pthread_join(threads[2], NULL);
     pthread_join(threads[3], NULL);
 
+    printf("Testing flat combining queue enqueue times for %d items:\n", Item_Count);
+    pthread_create(&threads[16], NULL, thread_enqueue, arg2);
+    pthread_create(&threads[17], NULL, thread_enqueue, arg2);
+    pthread_join(threads[16], NULL);
+    pthread_join(threads[17], NULL);
+
     printf("Testing Michael and Scott queue dequeue times for %d items:\n", Item_Count);
     pthread_create(&threads[4], NULL, thread_dequeue, arg0);
     pthread_create(&threads[5], NULL, thread_dequeue, arg0);
@@ -121,7 +237,47 @@ int main(int argc, char *argv[]) {
     pthread_join(threads[6], NULL);
     pthread_join(threads[7], NULL);
 
+    printf("Testing flat combining queue dequeue times for %d items:\n", Item_Count);
+    pthread_create(&threads[18], NULL, thread_dequeue, arg2);
+    pthread_create(&threads[19], NULL, thread_dequeue, arg2);
+    pthread_join(threads[18], NULL);
+    pthread_join(threads[19], NULL);
+
+    /*consumers start on empty queues and park until producers catch up*/
+    printf("Testing Michael and Scott queue blocking dequeue times for %d items:\n", Item_Count);
+    pthread_create(&threads[8], NULL, thread_dequeue_wait, arg0);
+    pthread_create(&threads[9], NULL, thread_dequeue_wait, arg0);
+    pthread_create(&threads[10], NULL, thread_enqueue, arg0);
+    pthread_create(&threads[11], NULL, thread_enqueue, arg0);
+    for(int i = 8; i < 12; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("Testing Lock Free queue blocking dequeue times for %d items:\n", Item_Count);
+    pthread_create(&threads[12], NULL, thread_dequeue_wait, arg1);
+    pthread_create(&threads[13], NULL, thread_dequeue_wait, arg1);
+    pthread_create(&threads[14], NULL, thread_enqueue, arg1);
+    pthread_create(&threads[15], NULL, thread_enqueue, arg1);
+    for(int i = 12; i < 16; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    test_timed_dequeue(0);
+    test_timed_dequeue(1);
+
+    stats_snapshot_t snap; /*everything above, all queues together*/
+    Stats_Snapshot(&snap);
+    Stats_Print(&snap, "Timing tests");
+
+    printf("Testing enqueue/dequeue throughput for %d pairs per thread:\n", Item_Count);
+    test_throughput(0, "Michael and Scott");
+    test_throughput(1, "Lock Free");
+    test_throughput(2, "Flat combining");
+
     /*Delete queues*/
     MS_Queue_Delete(MS);
     LF_Queue_Delete(LF);
+    FC_Queue_Delete(FC);
+    free(FC);
+    free(arg0); free(arg1); free(arg2);
 }
\ No newline at end of file
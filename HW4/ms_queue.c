@@ -4,6 +4,7 @@
 #include <assert.h>
 
 #include "ms_queue.h"
+#include "stats.h"
 
 void MS_Queue_Init(ms_queue_t *q) {
     ms_node_t *tmp = (ms_node_t *)malloc(sizeof(ms_node_t));
@@ -12,37 +13,67 @@ void MS_Queue_Init(ms_queue_t *q) {
     q->head = q->tail = tmp;
     pthread_mutex_init(&q->head_lock, NULL);
     pthread_mutex_init(&q->tail_lock, NULL);
+    EC_Init(&q->ec);
 }
 
 // Enqueue operation
 void MS_Queue_Enqueue(ms_queue_t *q, int value) {
     ms_node_t *tmp = (ms_node_t *)malloc(sizeof(ms_node_t));
     assert(tmp != NULL);
+    Stats_Count(STAT_MALLOC);
     tmp->value = value;
     tmp->next = NULL;
 
-    pthread_mutex_lock(&q->tail_lock);
+    uint64_t held = Stats_Lock(&q->tail_lock);
     q->tail->next = tmp;
     q->tail = tmp;
-    pthread_mutex_unlock(&q->tail_lock);
+    Stats_Unlock(&q->tail_lock, held);
+    EC_Signal(&q->ec); /*no syscall unless a consumer is parked*/
 }
 
 // Dequeue operation
-int MS_Queue_Dequeue(ms_queue_t *q) {
-    pthread_mutex_lock(&q->head_lock);
+bool MS_Queue_Dequeue(ms_queue_t *q, int *value) {
+    uint64_t held = Stats_Lock(&q->head_lock);
     ms_node_t *tmp = q->head;
     ms_node_t *new_head = tmp->next;
 
     if (new_head == NULL) {  // MS_Queue is empty
-        pthread_mutex_unlock(&q->head_lock);
-        return -1;
+        Stats_Unlock(&q->head_lock, held);
+        return false;
     }
 
-    int value = new_head->value;
+    *value = new_head->value;
     q->head = new_head;
-    pthread_mutex_unlock(&q->head_lock);
+    Stats_Unlock(&q->head_lock, held);
     free(tmp);
-    return value;
+    Stats_Count(STAT_FREE);
+    return true;
+}
+
+// Blocking dequeue, waits up to timeout (NULL waits forever)
+bool MS_Queue_Dequeue_Timed(ms_queue_t *q, int *value, const struct timespec *timeout) {
+    struct timespec deadline;
+    if (timeout != NULL) {
+        deadline = EC_Deadline(timeout);
+    }
+
+    while (1) {
+        if (MS_Queue_Dequeue(q, value)) {
+            return true;
+        }
+        uint32_t key = EC_Prepare(&q->ec);
+        if (MS_Queue_Dequeue(q, value)) {  // Re-check after registering
+            EC_Cancel(&q->ec);
+            return true;
+        }
+        if (!EC_Wait(&q->ec, key, timeout != NULL ? &deadline : NULL)) {
+            return MS_Queue_Dequeue(q, value);  // Timed out, last look
+        }
+    }
+}
+
+void MS_Queue_Dequeue_Wait(ms_queue_t *q, int *value) {
+    MS_Queue_Dequeue_Timed(q, value, NULL);
 }
 
 void MS_Queue_Delete(ms_queue_t *q) {
@@ -66,4 +97,5 @@ void MS_Queue_Delete(ms_queue_t *q) {
     // Destroy mutexes
     pthread_mutex_destroy(&q->head_lock);
     pthread_mutex_destroy(&q->tail_lock);
+    EC_Destroy(&q->ec);
 }
@@ -2,7 +2,11 @@
 #define MS_QUEUE_H
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <pthread.h>
+#include <time.h>
+
+#include "eventcount.h"
 
 // Node structure
 typedef struct ms_node_t {
@@ -15,12 +19,15 @@ typedef struct ms_queue_t {
     ms_node_t *head;
     ms_node_t *tail;
     pthread_mutex_t head_lock, tail_lock;
+    eventcount_t ec; /*parks consumers while the queue is empty*/
 } ms_queue_t;
 
 // Function prototypes
 void MS_Queue_Init(ms_queue_t *q);
 void MS_Queue_Enqueue(ms_queue_t *q, int value);
-int MS_Queue_Dequeue(ms_queue_t *q);
+bool MS_Queue_Dequeue(ms_queue_t *q, int *value); /*false if empty*/
+void MS_Queue_Dequeue_Wait(ms_queue_t *q, int *value); /*blocks until an item arrives*/
+bool MS_Queue_Dequeue_Timed(ms_queue_t *q, int *value, const struct timespec *timeout); /*false on timeout*/
 void MS_Queue_Delete(ms_queue_t *q);
 
 #endif 
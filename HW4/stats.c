@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+
+#ifdef CONTENTION_STATS
+
+static const char *counter_names[STAT_COUNT] = {
+    "lock acquires", "lock contended", "CAS attempts", "CAS failures",
+    "traversals", "traversal nodes", "mallocs", "frees",
+};
+
+static const char *hist_names[HIST_COUNT] = {
+    "lock wait (ns)", "lock hold (ns)", "traversal length",
+};
+
+_Thread_local stats_thread_t *Stats_Local = NULL;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static stats_thread_t *registry = NULL; /*every record ever handed out*/
+static pthread_key_t exit_key;
+static pthread_once_t exit_once = PTHREAD_ONCE_INIT;
+
+static void release_record(void *rec) { /*thread exit: keep the counts, free the record for reuse*/
+    atomic_store(&((stats_thread_t *)rec)->in_use, 0);
+}
+
+static void make_exit_key(void) {
+    pthread_key_create(&exit_key, release_record);
+}
+
+stats_thread_t *Stats_Register(void) {
+    pthread_once(&exit_once, make_exit_key);
+    pthread_mutex_lock(&registry_lock);
+    stats_thread_t *t = registry;
+    while (t != NULL && atomic_load(&t->in_use)) {
+        t = t->next;
+    }
+    if (t == NULL) { /*no record left behind by an exited thread*/
+        size_t size = (sizeof(stats_thread_t) + 63) / 64 * 64;
+        t = aligned_alloc(64, size); /*one cache line boundary per record*/
+        if (t == NULL) {
+            perror("malloc failure");
+            abort();
+        }
+        memset(t, 0, size);
+        t->next = registry;
+        registry = t;
+    }
+    atomic_store(&t->in_use, 1);
+    pthread_mutex_unlock(&registry_lock);
+
+    pthread_setspecific(exit_key, t);
+    Stats_Local = t;
+    return t;
+}
+
+void Stats_Snapshot(stats_snapshot_t *snap) {
+    memset(snap, 0, sizeof(*snap));
+    pthread_mutex_lock(&registry_lock);
+    for (stats_thread_t *t = registry; t != NULL; t = t->next) {
+        snap->threads++;
+        for (int c = 0; c < STAT_COUNT; c++) {
+            snap->counters[c] += atomic_load_explicit(&t->counters[c], memory_order_relaxed);
+        }
+        for (int h = 0; h < HIST_COUNT; h++) {
+            for (int b = 0; b < STATS_BUCKETS; b++) {
+                snap->hist[h][b] += atomic_load_explicit(&t->hist[h][b], memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void Stats_Reset(void) {
+    pthread_mutex_lock(&registry_lock);
+    for (stats_thread_t *t = registry; t != NULL; t = t->next) {
+        for (int c = 0; c < STAT_COUNT; c++) {
+            atomic_store_explicit(&t->counters[c], 0, memory_order_relaxed);
+        }
+        for (int h = 0; h < HIST_COUNT; h++) {
+            for (int b = 0; b < STATS_BUCKETS; b++) {
+                atomic_store_explicit(&t->hist[h][b], 0, memory_order_relaxed);
+            }
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+/*upper bound of the bucket holding the p-th value, 0 if the histogram is empty*/
+static uint64_t hist_percentile(const uint64_t *hist, double p) {
+    uint64_t total = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        total += hist[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(p * total + 0.5), seen = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= rank && hist[b] != 0) {
+            return b == 0 ? 0 : (1ull << b) - 1;
+        }
+    }
+    return (1ull << (STATS_BUCKETS - 1)) - 1;
+}
+
+void Stats_Print(const stats_snapshot_t *snap, const char *label) {
+    printf("%s contention stats (%d thread records):\n", label, snap->threads);
+    for (int c = 0; c < STAT_COUNT; c++) {
+        if (snap->counters[c] != 0) {
+            printf("  %-16s %llu\n", counter_names[c], (unsigned long long)snap->counters[c]);
+        }
+    }
+    for (int h = 0; h < HIST_COUNT; h++) {
+        uint64_t samples = 0;
+        for (int b = 0; b < STATS_BUCKETS; b++) {
+            samples += snap->hist[h][b];
+        }
+        if (samples == 0) {
+            continue;
+        }
+        printf("  %-16s %llu samples, p50 <= %llu, p99 <= %llu, max <= %llu\n", hist_names[h],
+               (unsigned long long)samples,
+               (unsigned long long)hist_percentile(snap->hist[h], 0.50),
+               (unsigned long long)hist_percentile(snap->hist[h], 0.99),
+               (unsigned long long)hist_percentile(snap->hist[h], 1.0));
+    }
+}
+
+#else
+
+void Stats_Snapshot(stats_snapshot_t *snap) {
+    memset(snap, 0, sizeof(*snap));
+}
+
+void Stats_Reset(void) {}
+
+void Stats_Print(const stats_snapshot_t *snap, const char *label) {
+    (void)snap;
+    (void)label;
+}
+
+#endif
@@ -0,0 +1,84 @@
+package main
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"os"
+)
+
+// Backend is the storage under a Disk. Disk serialises access, so
+// implementations need not be safe for concurrent use.
+type Backend interface {
+	ReadAt(p []byte, off int64) (int, error) // io.EOF past the written end
+	WriteAt(p []byte, off int64) (int, error)
+	Sync() error
+	Close() error
+}
+
+// viewer is implemented by backends that can expose their storage directly,
+// so reads on the parity paths skip the copy.
+type viewer interface {
+	View(off int64, n int) ([]byte, bool)
+}
+
+var ErrOutOfSpace = errors.New("write past end of disk")
+
+// OpenBackend opens a backend of the given kind: "file" (buffered os.File),
+// "mmap" (memory-mapped file), "direct" (O_DIRECT file) or "mem" (RAM
+// disk). size is the disk capacity in bytes, used by the fixed-size kinds.
+func OpenBackend(kind, filename string, size int64) (Backend, error) {
+	switch kind {
+	case "file":
+		f, err := os.OpenFile(filename, os.O_RDWR|os.O_CREATE|os.O_TRUNC, 0666)
+		if err != nil {
+			return nil, err
+		}
+		return f, nil
+	case "mmap":
+		return openMmapBackend(filename, size)
+	case "direct":
+		return openDirectBackend(filename)
+	case "mem":
+		return &memBackend{data: make([]byte, size)}, nil
+	default:
+		return nil, fmt.Errorf("unknown disk backend %q", kind)
+	}
+}
+
+// memBackend is a RAM disk of fixed size.
+type memBackend struct {
+	data []byte
+}
+
+func (m *memBackend) ReadAt(p []byte, off int64) (int, error) {
+	if off >= int64(len(m.data)) {
+		return 0, io.EOF
+	}
+	n := copy(p, m.data[off:])
+	if n < len(p) {
+		return n, io.EOF
+	}
+	return n, nil
+}
+
+func (m *memBackend) WriteAt(p []byte, off int64) (int, error) {
+	if off+int64(len(p)) > int64(len(m.data)) {
+		return 0, ErrOutOfSpace
+	}
+	return copy(m.data[off:], p), nil
+}
+
+func (m *memBackend) View(off int64, n int) ([]byte, bool) {
+	if off+int64(n) > int64(len(m.data)) {
+		return nil, false
+	}
+	return m.data[off : off+int64(n) : off+int64(n)], true
+}
+
+func (m *memBackend) Sync() error { return nil }
+
+func (m *memBackend) Close() error {
+	m.data = nil
+	return nil
+}
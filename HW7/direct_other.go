@@ -0,0 +1,9 @@
+//go:build !linux
+
+package main
+
+import "errors"
+
+func openDirectBackend(filename string) (Backend, error) {
+	return nil, errors.New("O_DIRECT disk backend is only supported on Linux")
+}
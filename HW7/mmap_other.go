@@ -0,0 +1,9 @@
+//go:build !(linux || darwin)
+
+package main
+
+import "errors"
+
+func openMmapBackend(filename string, size int64) (Backend, error) {
+	return nil, errors.New("mmap disk backend is not supported on this platform")
+}
@@ -0,0 +1,90 @@
+//go:build linux || darwin
+
+package main
+
+import (
+	"io"
+	"os"
+	"syscall"
+	"unsafe"
+)
+
+// mmapBackend maps a fixed-size file into memory. Writes are copies into
+// the mapping; Sync msyncs only the pages dirtied since the last Sync.
+type mmapBackend struct {
+	file   *os.File
+	data   []byte
+	lo, hi int64 // dirty byte range, empty when lo >= hi
+}
+
+func openMmapBackend(filename string, size int64) (Backend, error) {
+	f, err := os.OpenFile(filename, os.O_RDWR|os.O_CREATE|os.O_TRUNC, 0666)
+	if err != nil {
+		return nil, err
+	}
+	if err := f.Truncate(size); err != nil {
+		f.Close()
+		return nil, err
+	}
+	data, err := syscall.Mmap(int(f.Fd()), 0, int(size), syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+	if err != nil {
+		f.Close()
+		return nil, err
+	}
+	return &mmapBackend{file: f, data: data}, nil
+}
+
+func (m *mmapBackend) ReadAt(p []byte, off int64) (int, error) {
+	if off >= int64(len(m.data)) {
+		return 0, io.EOF
+	}
+	n := copy(p, m.data[off:])
+	if n < len(p) {
+		return n, io.EOF
+	}
+	return n, nil
+}
+
+func (m *mmapBackend) WriteAt(p []byte, off int64) (int, error) {
+	end := off + int64(len(p))
+	if end > int64(len(m.data)) {
+		return 0, ErrOutOfSpace
+	}
+	if m.lo >= m.hi {
+		m.lo, m.hi = off, end
+	} else {
+		m.lo, m.hi = min(m.lo, off), max(m.hi, end)
+	}
+	return copy(m.data[off:], p), nil
+}
+
+func (m *mmapBackend) View(off int64, n int) ([]byte, bool) {
+	if off+int64(n) > int64(len(m.data)) {
+		return nil, false
+	}
+	return m.data[off : off+int64(n) : off+int64(n)], true
+}
+
+func (m *mmapBackend) Sync() error {
+	if m.lo >= m.hi {
+		return nil
+	}
+	page := int64(os.Getpagesize())
+	lo := m.lo &^ (page - 1)
+	dirty := m.data[lo:m.hi]
+	m.lo, m.hi = 0, 0
+	_, _, errno := syscall.Syscall(syscall.SYS_MSYNC, uintptr(unsafe.Pointer(&dirty[0])), uintptr(len(dirty)), syscall.MS_SYNC)
+	if errno != 0 {
+		return errno
+	}
+	return nil
+}
+
+func (m *mmapBackend) Close() error {
+	err := syscall.Munmap(m.data)
+	m.data = nil
+	if cerr := m.file.Close(); err == nil {
+		err = cerr
+	}
+	return err
+}
@@ -3,9 +3,15 @@ package main
 import (
 	"crypto/rand"
 	"errors"
+	"flag"
 	"fmt"
+	"io"
+	"math"
+	mrand "math/rand"
 	"os"
+	"strings"
 	"sync"
+	"sync/atomic"
 	"time"
 )
 
@@ -17,45 +23,131 @@ const (
 type RAID interface {
 	Write(blockNum int, data []byte) error
 	Read(blockNum int) ([]byte, error)
+	Flush() error // write out any buffered stripes
 }
 
+// Redundant arrays keep serving I/O with one failed disk and can rebuild it
+// onto a replacement while online.
+type Redundant interface {
+	RAID
+	FailDisk(index int)
+	Rebuild(index int, replacement *Disk, stripes int, rate float64) <-chan error
+}
+
+var ErrDiskFailed = errors.New("disk failed")
+
 type Disk struct {
-	file *os.File
-	mu   sync.Mutex
+	backend Backend
+	mu      sync.Mutex
+	reads   atomic.Int64 // block reads issued
+	writes  atomic.Int64 // block writes issued
+	failed  atomic.Bool
+	valid   atomic.Int64 // blocks below this hold good data (rebuild watermark)
 }
 
+// NewDisk truncates the file so every array starts out all zeros, which
+// keeps parity consistent with the data from the first write on.
 func NewDisk(filename string) (*Disk, error) {
-	f, err := os.OpenFile(filename, os.O_RDWR|os.O_CREATE, 0666)
+	b, err := OpenBackend("file", filename, 0)
 	if err != nil {
 		return nil, err
 	}
-	return &Disk{file: f}, nil
+	return NewDiskOn(b), nil
+}
+
+// NewDiskOn makes a disk on an already opened backend, which must start
+// out all zeros.
+func NewDiskOn(b Backend) *Disk {
+	d := &Disk{backend: b}
+	d.valid.Store(math.MaxInt64)
+	return d
+}
+
+func (d *Disk) Close() error {
+	d.mu.Lock()
+	defer d.mu.Unlock()
+	return d.backend.Close()
+}
+
+// Fail marks the disk as failed; all further I/O to it returns ErrDiskFailed.
+func (d *Disk) Fail() {
+	d.failed.Store(true)
+	d.valid.Store(0)
+}
+
+// Available reports whether the disk holds good data for blockNum. A
+// replacement disk only becomes available stripe by stripe as it is rebuilt.
+func (d *Disk) Available(blockNum int) bool {
+	return !d.failed.Load() && int64(blockNum) < d.valid.Load()
 }
 
 func (d *Disk) WriteBlock(blockNum int, data []byte) error {
 	if len(data) != BlockSize {
 		return fmt.Errorf("data must be exactly %d bytes", BlockSize)
 	}
+	if d.failed.Load() {
+		return ErrDiskFailed
+	}
+	d.writes.Add(1)
 	d.mu.Lock()
 	defer d.mu.Unlock()
 	offset := int64(blockNum) * BlockSize
-	_, err := d.file.WriteAt(data, offset)
+	_, err := d.backend.WriteAt(data, offset)
 	if err != nil {
 		return err
 	}
-	return d.file.Sync() // ensure fsync
+	return d.backend.Sync() // ensure fsync
 }
 
 func (d *Disk) ReadBlock(blockNum int) ([]byte, error) {
 	buf := make([]byte, BlockSize)
+	if err := d.ReadBlockInto(buf, blockNum); err != nil {
+		return nil, err
+	}
+	return buf, nil
+}
+
+// ReadBlockInto reads a block into a caller-supplied BlockSize buffer.
+func (d *Disk) ReadBlockInto(buf []byte, blockNum int) error {
+	if len(buf) != BlockSize {
+		return fmt.Errorf("buffer must be exactly %d bytes", BlockSize)
+	}
+	if d.failed.Load() {
+		return ErrDiskFailed
+	}
+	d.reads.Add(1)
 	d.mu.Lock()
 	defer d.mu.Unlock()
 	offset := int64(blockNum) * BlockSize
-	_, err := d.file.ReadAt(buf, offset)
-	if err != nil {
+	n, err := d.backend.ReadAt(buf, offset)
+	if err == io.EOF {
+		// never-written blocks read back as zeros
+		clear(buf[n:])
+		err = nil
+	}
+	return err
+}
+
+// peekBlock returns a block without copying when the backend can expose its
+// storage, and otherwise reads it into scratch. The result must not be
+// modified and is only good until the block is next written, so it is for
+// short-lived use under the array lock, such as folding into parity.
+func (d *Disk) peekBlock(scratch []byte, blockNum int) ([]byte, error) {
+	if v, ok := d.backend.(viewer); ok && !d.failed.Load() {
+		if b, ok := v.View(int64(blockNum)*BlockSize, BlockSize); ok {
+			d.reads.Add(1)
+			return b, nil
+		}
+	}
+	if err := d.ReadBlockInto(scratch, blockNum); err != nil {
 		return nil, err
 	}
-	return buf, nil
+	return scratch, nil
+}
+
+// IOCount returns the number of block reads and writes issued to the disk.
+func (d *Disk) IOCount() (reads, writes int64) {
+	return d.reads.Load(), d.writes.Load()
 }
 
 // RAID 0 (striping, no redundancy)
@@ -79,6 +171,8 @@ func (r *RAID0) Read(blockNum int) ([]byte, error) {
 	return r.disks[diskIndex].ReadBlock(diskBlock)
 }
 
+func (r *RAID0) Flush() error { return nil }
+
 // RAID 1 (mirroring)
 type RAID1 struct {
 	disks []*Disk
@@ -101,99 +195,143 @@ func (r *RAID1) Read(blockNum int) ([]byte, error) {
 	return r.disks[0].ReadBlock(blockNum)
 }
 
+func (r *RAID1) Flush() error { return nil }
+
 // RAID 4 (striping with dedicated parity)
 type RAID4 struct {
-	dataDisks  []*Disk
-	parityDisk *Disk
+	disks     []*Disk // data disks followed by the parity disk
+	dataDisks []*Disk
+	mu        sync.Mutex
+	buf       stripeBuffer
 }
 
 func NewRAID4(disks []*Disk) *RAID4 {
 	return &RAID4{
-		dataDisks:  disks[:len(disks)-1],
-		parityDisk: disks[len(disks)-1],
+		disks:     disks,
+		dataDisks: disks[:len(disks)-1],
+		buf:       newStripeBuffer(len(disks) - 1),
 	}
 }
 
 func (r *RAID4) Write(blockNum int, data []byte) error {
+	if len(data) != BlockSize {
+		return fmt.Errorf("data must be exactly %d bytes", BlockSize)
+	}
 	diskIndex := blockNum % len(r.dataDisks)
 	diskBlock := blockNum / len(r.dataDisks)
 
-	// Read existing blocks for parity calculation
-	parity := make([]byte, BlockSize)
-	for i, disk := range r.dataDisks {
-		if i == diskIndex {
-			continue
-		}
-		block, _ := disk.ReadBlock(diskBlock)
-		for j := range parity {
-			parity[j] ^= block[j]
-		}
-	}
-	for j := range parity {
-		parity[j] ^= data[j]
-	}
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.buf.add(diskBlock, diskIndex, data, r.flushStripe)
+}
 
-	if err := r.dataDisks[diskIndex].WriteBlock(diskBlock, data); err != nil {
-		return err
-	}
-	return r.parityDisk.WriteBlock(diskBlock, parity)
+func (r *RAID4) flushStripe(stripe int, blocks [][]byte) error {
+	return writeStripe(r.dataDisks, r.disks[len(r.disks)-1], stripe, blocks)
 }
 
 func (r *RAID4) Read(blockNum int) ([]byte, error) {
 	diskIndex := blockNum % len(r.dataDisks)
 	diskBlock := blockNum / len(r.dataDisks)
-	return r.dataDisks[diskIndex].ReadBlock(diskBlock)
+
+	r.mu.Lock()
+	if b := r.buf.lookup(diskBlock, diskIndex); b != nil {
+		out := append([]byte(nil), b...)
+		r.mu.Unlock()
+		return out, nil
+	}
+	disk := r.dataDisks[diskIndex]
+	r.mu.Unlock()
+
+	if disk.Available(diskBlock) {
+		if b, err := disk.ReadBlock(diskBlock); err != ErrDiskFailed {
+			return b, err
+		}
+	}
+	// Degraded read
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	block := make([]byte, BlockSize)
+	if err := reconstructBlock(block, r.disks, diskIndex, diskBlock); err != nil {
+		return nil, err
+	}
+	return block, nil
+}
+
+func (r *RAID4) Flush() error {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.buf.flush(r.flushStripe)
+}
+
+func (r *RAID4) FailDisk(index int) {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	r.disks[index].Fail()
+}
+
+// Rebuild swaps replacement in for disk index and regenerates its contents
+// in the background at up to rate bytes/sec (0 for unlimited). The returned
+// channel yields the result once all stripes are rebuilt.
+func (r *RAID4) Rebuild(index int, replacement *Disk, stripes int, rate float64) <-chan error {
+	replacement.valid.Store(0)
+	r.mu.Lock()
+	r.disks[index] = replacement
+	r.mu.Unlock()
+
+	done := make(chan error, 1)
+	go func() {
+		done <- rebuildDisk(&r.mu, replacement, stripes, rate, func(dst []byte, stripe int) error {
+			return reconstructBlock(dst, r.disks, index, stripe)
+		})
+	}()
+	return done
 }
 
 // RAID 5 (striping with distributed parity)
 type RAID5 struct {
-	disks []*Disk
+	disks   []*Disk
+	mu      sync.Mutex
+	buf     stripeBuffer
+	scratch []*Disk // stripeDisks result, reused under mu
 }
 
 func NewRAID5(disks []*Disk) *RAID5 {
-	return &RAID5{disks}
+	return &RAID5{
+		disks:   disks,
+		buf:     newStripeBuffer(len(disks) - 1),
+		scratch: make([]*Disk, 0, len(disks)-1),
+	}
 }
 
-func (r *RAID5) Write(blockNum int, data []byte) error {
-	numDataDisks := len(r.disks) - 1
-	stripe := blockNum / numDataDisks
-	indexInStripe := blockNum % numDataDisks
+// stripeDisks returns the data disks of a stripe in slot order and the
+// index of its parity disk. Callers must hold mu.
+func (r *RAID5) stripeDisks(stripe int) ([]*Disk, int) {
 	parityIndex := stripe % len(r.disks)
-
-	dataDiskIndex := 0
-	for i := 0; i < len(r.disks); i++ {
-		if i == parityIndex {
-			continue
-		}
-		if dataDiskIndex == indexInStripe {
-			return r.writeStripe(stripe, parityIndex, i, data)
+	data := r.scratch[:0]
+	for i, disk := range r.disks {
+		if i != parityIndex {
+			data = append(data, disk)
 		}
-		dataDiskIndex++
 	}
-	return nil
+	return data, parityIndex
 }
 
-func (r *RAID5) writeStripe(stripe, parityIndex, writeIndex int, data []byte) error {
-	parity := make([]byte, BlockSize)
-
-	for i := 0; i < len(r.disks); i++ {
-		if i == parityIndex || i == writeIndex {
-			continue
-		}
-		block, _ := r.disks[i].ReadBlock(stripe)
-		for j := range parity {
-			parity[j] ^= block[j]
-		}
+func (r *RAID5) Write(blockNum int, data []byte) error {
+	if len(data) != BlockSize {
+		return fmt.Errorf("data must be exactly %d bytes", BlockSize)
 	}
+	numDataDisks := len(r.disks) - 1
+	stripe := blockNum / numDataDisks
+	indexInStripe := blockNum % numDataDisks
 
-	for j := range parity {
-		parity[j] ^= data[j]
-	}
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.buf.add(stripe, indexInStripe, data, r.writeStripe)
+}
 
-	if err := r.disks[writeIndex].WriteBlock(stripe, data); err != nil {
-		return err
-	}
-	return r.disks[parityIndex].WriteBlock(stripe, parity)
+func (r *RAID5) writeStripe(stripe int, blocks [][]byte) error {
+	data, parityIndex := r.stripeDisks(stripe)
+	return writeStripe(data, r.disks[parityIndex], stripe, blocks)
 }
 
 func (r *RAID5) Read(blockNum int) ([]byte, error) {
@@ -202,23 +340,73 @@ func (r *RAID5) Read(blockNum int) ([]byte, error) {
 	indexInStripe := blockNum % numDataDisks
 	parityIndex := stripe % len(r.disks)
 
-	dataDiskIndex := 0
-	for i := 0; i < len(r.disks); i++ {
-		if i == parityIndex {
-			continue
-		}
-		if dataDiskIndex == indexInStripe {
-			return r.disks[i].ReadBlock(stripe)
+	// skip over the parity disk to find the physical disk
+	diskIndex := indexInStripe
+	if diskIndex >= parityIndex {
+		diskIndex++
+	}
+
+	r.mu.Lock()
+	if b := r.buf.lookup(stripe, indexInStripe); b != nil {
+		out := append([]byte(nil), b...)
+		r.mu.Unlock()
+		return out, nil
+	}
+	disk := r.disks[diskIndex]
+	r.mu.Unlock()
+
+	if disk.Available(stripe) {
+		if b, err := disk.ReadBlock(stripe); err != ErrDiskFailed {
+			return b, err
 		}
-		dataDiskIndex++
 	}
-	return nil, errors.New("invalid block number")
+	// Degraded read
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	block := make([]byte, BlockSize)
+	if err := reconstructBlock(block, r.disks, diskIndex, stripe); err != nil {
+		return nil, err
+	}
+	return block, nil
+}
+
+func (r *RAID5) Flush() error {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.buf.flush(r.writeStripe)
+}
+
+func (r *RAID5) FailDisk(index int) {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	r.disks[index].Fail()
+}
+
+// Rebuild swaps replacement in for disk index and regenerates its contents
+// in the background at up to rate bytes/sec (0 for unlimited). The returned
+// channel yields the result once all stripes are rebuilt.
+func (r *RAID5) Rebuild(index int, replacement *Disk, stripes int, rate float64) <-chan error {
+	replacement.valid.Store(0)
+	r.mu.Lock()
+	r.disks[index] = replacement
+	r.mu.Unlock()
+
+	done := make(chan error, 1)
+	go func() {
+		done <- rebuildDisk(&r.mu, replacement, stripes, rate, func(dst []byte, stripe int) error {
+			return reconstructBlock(dst, r.disks, index, stripe)
+		})
+	}()
+	return done
 }
 
 // benchmark constants
 const (
 	TotalSize = 50 * 1024 * 1024 // 50MB - change to simulate load
 	NumBlocks = TotalSize / BlockSize
+
+	RebuildRate = 20 * 1024 * 1024 // bytes/sec for online rebuild, 0 for unlimited
+	CacheBlocks = NumBlocks / 4    // block cache capacity
 )
 
 // generate random data
@@ -232,50 +420,169 @@ func generateData() [][]byte {
 	return data
 }
 
-func benchmarkRAID(name string, raid RAID, data [][]byte) {
+// count block I/Os issued across an array
+func diskIO(disks []*Disk) (reads, writes int64) {
+	for _, d := range disks {
+		r, w := d.IOCount()
+		reads += r
+		writes += w
+	}
+	return reads, writes
+}
+
+func benchmarkRAID(name string, raid RAID, disks []*Disk, data [][]byte) {
 	fmt.Printf("Benchmarking %s:\n", name)
 	fmt.Printf("Data length: %d\n", len(data))
 	// Write benchmark
+	var done atomic.Int64
+	stopProgress := startProgress("Write", &done, len(data))
 	start := time.Now()
 	for i, block := range data {
 		if err := raid.Write(i, block); err != nil {
+			stopProgress()
 			fmt.Printf("Write error at block %d: %v\n", i, err)
 			return
 		}
-		// Calculate percentage of progress
-		progress := (float64(i+1) / float64(len(data))) * 100
-
-		// Display progress as percentage
-		fmt.Printf("\rWrite Progress: %.2f%%", progress)
+		done.Add(1)
+	}
+	stopProgress()
+	if err := raid.Flush(); err != nil {
+		fmt.Printf("Flush error: %v\n", err)
+		return
 	}
 	writeTime := time.Since(start)
+	seqReads, seqWrites := diskIO(disks)
+
+	// Random overwrite benchmark (small writes, no stripe coalescing)
+	numUpdates := len(data) / 8
+	start = time.Now()
+	for i := 0; i < numUpdates; i++ {
+		blockNum := mrand.Intn(len(data))
+		if err := raid.Write(blockNum, data[i]); err != nil {
+			fmt.Printf("Write error at block %d: %v\n", blockNum, err)
+			return
+		}
+	}
+	if err := raid.Flush(); err != nil {
+		fmt.Printf("Flush error: %v\n", err)
+		return
+	}
+	updateTime := time.Since(start)
+	rndReads, rndWrites := diskIO(disks)
+	rndReads, rndWrites = rndReads-seqReads, rndWrites-seqWrites
 
 	// Read benchmark
+	done.Store(0)
+	stopProgress = startProgress("Read", &done, NumBlocks)
 	start = time.Now()
 	for i := 0; i < NumBlocks; i++ {
 		if _, err := raid.Read(i); err != nil {
+			stopProgress()
 			fmt.Printf("Read error at block %d: %v\n", i, err)
 			return
 		}
-		// Calculate percentage of progress
-		progress := (float64(i+1) / float64(len(data))) * 100
-
-		// Display progress as percentage
-		fmt.Printf("\rRead Progress: %.2f%%", progress)
+		done.Add(1)
 	}
 	readTime := time.Since(start)
+	stopProgress()
 
-	fmt.Printf("\nWrite time: %v (%.2f µs/block)\n", writeTime, float64(writeTime.Microseconds())/NumBlocks)
+	fmt.Printf("Write time: %v (%.2f µs/block)\n", writeTime, float64(writeTime.Microseconds())/NumBlocks)
 	fmt.Printf("Read time:  %v (%.2f µs/block)\n", readTime, float64(readTime.Microseconds())/NumBlocks)
+	fmt.Printf("Random write time: %v (%.2f µs/block)\n", updateTime, float64(updateTime.Microseconds())/float64(numUpdates))
+	fmt.Printf("Sequential I/Os per write: %.2f reads, %.2f writes\n",
+		float64(seqReads)/float64(len(data)), float64(seqWrites)/float64(len(data)))
+	fmt.Printf("Random I/Os per write:     %.2f reads, %.2f writes\n",
+		float64(rndReads)/float64(numUpdates), float64(rndWrites)/float64(numUpdates))
+	fmt.Println()
+}
+
+// fail the given disks, then time degraded reads and an online rebuild
+// of each failed disk in turn. disks is the array's member slice; each
+// failed disk is closed once its spare has taken over.
+func benchmarkDegraded(name string, raid Redundant, disks []*Disk, parityDisks int, failIndexes ...int) {
+	fmt.Printf("Degraded %s (disks %v failed):\n", name, failIndexes)
+	for _, index := range failIndexes {
+		raid.FailDisk(index)
+	}
+
+	// Degraded read benchmark
+	start := time.Now()
+	for i := 0; i < NumBlocks; i++ {
+		if _, err := raid.Read(i); err != nil {
+			fmt.Printf("Degraded read error at block %d: %v\n", i, err)
+			return
+		}
+	}
+	degradedTime := time.Since(start)
+
+	// Online rebuild with foreground reads running alongside
+	dataDisks := NumDisks - parityDisks
+	stripes := (NumBlocks + dataDisks - 1) / dataDisks
+	reads := 0
+	start = time.Now()
+	for _, index := range failIndexes {
+		spare, err := createDisk(fmt.Sprintf("%s-spare%d.dat", diskPrefix(name), index))
+		if err != nil {
+			fmt.Printf("Spare disk error: %v\n", err)
+			return
+		}
+		failed := disks[index]
+		done := raid.Rebuild(index, spare, stripes, RebuildRate)
+		for rebuilding := true; rebuilding; {
+			select {
+			case err = <-done:
+				rebuilding = false
+			default:
+				if _, err := raid.Read(reads % NumBlocks); err != nil {
+					fmt.Printf("Read error during rebuild at block %d: %v\n", reads%NumBlocks, err)
+					<-done
+					return
+				}
+				reads++
+			}
+		}
+		if err != nil {
+			fmt.Printf("Rebuild error: %v\n", err)
+			return
+		}
+		failed.Close()
+	}
+	rebuildTime := time.Since(start)
+
+	fmt.Printf("Degraded read time: %v (%.2f µs/block)\n", degradedTime, float64(degradedTime.Microseconds())/NumBlocks)
+	fmt.Printf("Rebuild time: %v (%.2f MB/s, %d foreground reads at %.2f µs/block)\n", rebuildTime,
+		float64(len(failIndexes)*stripes*BlockSize)/(1024*1024)/rebuildTime.Seconds(), reads,
+		float64(rebuildTime.Microseconds())/float64(max(reads, 1)))
 	fmt.Println()
 }
 
 // create disk files
-func createDisks() ([]*Disk, error) {
+var diskBackend = flag.String("backend", "file", "disk backend: file, mmap, direct or mem")
+
+func createDisk(filename string) (*Disk, error) {
+	if *diskBackend == "file" {
+		return NewDisk(filename)
+	}
+	// each disk holds at most every block, as under RAID 1
+	b, err := OpenBackend(*diskBackend, filename, int64(NumBlocks)*BlockSize)
+	if err != nil {
+		return nil, err
+	}
+	return NewDiskOn(b), nil
+}
+
+// diskPrefix turns an array name such as "RAID 5 + cache" into a file name
+// prefix, so no two arrays ever open the same disk files.
+func diskPrefix(name string) string {
+	return strings.ToLower(strings.Join(strings.Fields(name), ""))
+}
+
+func createDisks(name string) ([]*Disk, error) {
 	disks := make([]*Disk, NumDisks)
 	for i := 0; i < NumDisks; i++ {
-		disk, err := NewDisk(fmt.Sprintf("disk%d.dat", i))
+		disk, err := createDisk(fmt.Sprintf("%s-disk%d.dat", diskPrefix(name), i))
 		if err != nil {
+			closeDisks(disks[:i])
 			return nil, err
 		}
 		disks[i] = disk
@@ -283,6 +590,16 @@ func createDisks() ([]*Disk, error) {
 	return disks, nil
 }
 
+// closeDisks releases an array's disks once its benchmarks are done; with
+// the mmap backend this also unmaps them.
+func closeDisks(disks []*Disk) {
+	for _, disk := range disks {
+		if err := disk.Close(); err != nil {
+			fmt.Printf("Close error: %v\n", err)
+		}
+	}
+}
+
 // effective load capacity
 func effectiveCapacity(raidType string, numDisks int, diskSize int64) int64 {
 	switch raidType {
@@ -292,33 +609,97 @@ func effectiveCapacity(raidType string, numDisks int, diskSize int64) int64 {
 		return diskSize
 	case "RAID 4", "RAID 5":
 		return int64(numDisks-1) * diskSize
+	case "RAID 6":
+		return int64(numDisks-2) * diskSize
 	default:
 		return 0
 	}
 }
 
 func main() {
+	flag.Parse()
+	newDisks := func(name string) []*Disk {
+		disks, err := createDisks(name)
+		if err != nil {
+			fmt.Printf("Disk error: %v\n", err)
+			os.Exit(1)
+		}
+		return disks
+	}
+	fmt.Printf("Disk backend: %s\n\n", *diskBackend)
+
+	benchmarkXOR()
+
 	data := generateData()
 
 	// RAID 0
-	disks0, _ := createDisks()
+	disks0 := newDisks("RAID 0")
 	raid0 := NewRAID0(disks0)
-	benchmarkRAID("RAID 0", raid0, data)
+	benchmarkRAID("RAID 0", raid0, disks0, data)
+	closeDisks(disks0)
 
 	// RAID 1
-	disks1, _ := createDisks()
+	disks1 := newDisks("RAID 1")
 	raid1 := NewRAID1(disks1)
-	benchmarkRAID("RAID 1", raid1, data)
+	benchmarkRAID("RAID 1", raid1, disks1, data)
+	closeDisks(disks1)
 
 	// RAID 4
-	disks4, _ := createDisks()
+	disks4 := newDisks("RAID 4")
 	raid4 := NewRAID4(disks4)
-	benchmarkRAID("RAID 4", raid4, data)
+	benchmarkRAID("RAID 4", raid4, disks4, data)
+	benchmarkDegraded("RAID 4", raid4, disks4, 1, 1)
+	closeDisks(disks4)
 
 	// RAID 5
-	disks5, _ := createDisks()
+	disks5 := newDisks("RAID 5")
 	raid5 := NewRAID5(disks5)
-	benchmarkRAID("RAID 5", raid5, data)
+	benchmarkRAID("RAID 5", raid5, disks5, data)
+	benchmarkDegraded("RAID 5", raid5, disks5, 1, 1)
+	closeDisks(disks5)
+
+	// RAID 6
+	disks6 := newDisks("RAID 6")
+	raid6 := NewRAID6(disks6)
+	benchmarkRAID("RAID 6", raid6, disks6, data)
+	benchmarkDegraded("RAID 6", raid6, disks6, 2, 1, 3)
+	closeDisks(disks6)
+
+	// RAID 5 behind a write-back block cache
+	disksC := newDisks("RAID 5 + cache")
+	cache := NewBlockCache(NewRAID5(disksC), CacheBlocks, NumDisks-1)
+	benchmarkRAID("RAID 5 + cache", cache, disksC, data)
+	benchmarkCache("RAID 5 + cache", cache)
+	closeDisks(disksC)
+
+	// Concurrent mixed workloads, one fresh array per level
+	workloads := []Workload{
+		{Name: "randread", Clients: 4, QueueDepth: 2, Pattern: Random, ReadPct: 100, BlocksPerIO: 1},
+		{Name: "randrw-70/30", Clients: 4, QueueDepth: 2, Pattern: Random, ReadPct: 70, BlocksPerIO: 1},
+		{Name: "zipf-rw-70/30", Clients: 4, QueueDepth: 2, Pattern: Zipfian, ReadPct: 70, BlocksPerIO: 1},
+		{Name: "seqwrite-16k", Clients: 4, QueueDepth: 2, Pattern: Sequential, ReadPct: 0, BlocksPerIO: 4},
+	}
+	for i := range workloads {
+		workloads[i].Ops = NumBlocks / 4
+		workloads[i].Blocks = NumBlocks
+	}
+	fmt.Println("Workloads (JSON lines):")
+	arrays := []struct {
+		name string
+		new  func([]*Disk) RAID
+	}{
+		{"RAID 0", func(d []*Disk) RAID { return NewRAID0(d) }},
+		{"RAID 1", func(d []*Disk) RAID { return NewRAID1(d) }},
+		{"RAID 4", func(d []*Disk) RAID { return NewRAID4(d) }},
+		{"RAID 5", func(d []*Disk) RAID { return NewRAID5(d) }},
+		{"RAID 6", func(d []*Disk) RAID { return NewRAID6(d) }},
+	}
+	for _, a := range arrays {
+		disksW := newDisks(a.name + " workload")
+		benchmarkWorkloads(a.name, a.new(disksW), workloads)
+		closeDisks(disksW)
+	}
+	fmt.Println()
 
 	//Print ELC (Effective Load Capacity)
 	fmt.Println("Effective Storage Capacities:")
@@ -326,5 +707,6 @@ func main() {
 	fmt.Printf("RAID 1: %d MB\n", effectiveCapacity("RAID 1", NumDisks, BlockSize*NumBlocks/NumDisks)/(1024*1024))
 	fmt.Printf("RAID 4: %d MB\n", effectiveCapacity("RAID 4", NumDisks, BlockSize*NumBlocks/NumDisks)/(1024*1024))
 	fmt.Printf("RAID 5: %d MB\n", effectiveCapacity("RAID 5", NumDisks, BlockSize*NumBlocks/NumDisks)/(1024*1024))
+	fmt.Printf("RAID 6: %d MB\n", effectiveCapacity("RAID 6", NumDisks, BlockSize*NumBlocks/NumDisks)/(1024*1024))
 	fmt.Println()
 }
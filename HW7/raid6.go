@@ -0,0 +1,418 @@
+package main
+
+import (
+	"fmt"
+	"sync"
+)
+
+// GF(2^8) arithmetic over the RAID 6 polynomial x^8+x^4+x^3+x^2+1 (0x11d)
+// with generator 2. gfMulTable[c] maps every byte b to c*b, so multiplying a
+// block by a constant is one table lookup per byte.
+var (
+	gfExp      [512]byte
+	gfLog      [256]byte
+	gfMulTable [256][256]byte
+)
+
+func init() {
+	x := 1
+	for i := 0; i < 255; i++ {
+		gfExp[i] = byte(x)
+		gfLog[x] = byte(i)
+		x <<= 1
+		if x&0x100 != 0 {
+			x ^= 0x11d
+		}
+	}
+	for i := 255; i < len(gfExp); i++ {
+		gfExp[i] = gfExp[i-255]
+	}
+	for a := 1; a < 256; a++ {
+		for b := 1; b < 256; b++ {
+			gfMulTable[a][b] = gfExp[int(gfLog[a])+int(gfLog[b])]
+		}
+	}
+}
+
+func gfInv(a byte) byte { return gfExp[255-int(gfLog[a])] }
+
+// gfMulBlock sets dst = c*src; dst may alias src.
+func gfMulBlock(dst, src []byte, c byte) {
+	t := &gfMulTable[c]
+	src = src[:len(dst)]
+	for i, b := range src {
+		dst[i] = t[b]
+	}
+}
+
+// gfMulXor sets dst ^= c*src.
+func gfMulXor(dst, src []byte, c byte) {
+	switch c {
+	case 0:
+		return
+	case 1:
+		xorBlocks(dst, dst, src)
+		return
+	}
+	t := &gfMulTable[c]
+	src = src[:len(dst)]
+	for i, b := range src {
+		dst[i] ^= t[b]
+	}
+}
+
+// computePQ sets P to the XOR of the data blocks and Q to sum(g^i * D_i).
+func computePQ(P, Q []byte, data [][]byte) {
+	xorBlocks(P, data...)
+	clear(Q)
+	for i, d := range data {
+		gfMulXor(Q, d, gfExp[i])
+	}
+}
+
+// recoverData rebuilds the lost data slots (at most two, ascending) in
+// place from the surviving slots and whichever of P and Q survived (nil
+// if lost).
+func recoverData(data [][]byte, lost []int, P, Q []byte) error {
+	switch len(lost) {
+	case 0:
+		return nil
+	case 1:
+		x := lost[0]
+		dx := data[x]
+		if P != nil {
+			// D_x = P ^ sum of the other D_i
+			copy(dx, P)
+			for i, d := range data {
+				if i != x {
+					xorBlocks(dx, dx, d)
+				}
+			}
+			return nil
+		}
+		if Q == nil {
+			return ErrTooManyFailures
+		}
+		// D_x = g^-x * (Q ^ sum of the other g^i * D_i)
+		copy(dx, Q)
+		for i, d := range data {
+			if i != x {
+				gfMulXor(dx, d, gfExp[i])
+			}
+		}
+		gfMulBlock(dx, dx, gfInv(gfExp[x]))
+		return nil
+	case 2:
+		if P == nil || Q == nil {
+			return ErrTooManyFailures
+		}
+		x, y := lost[0], lost[1]
+		dx, dy := data[x], data[y]
+		// With Pxy and Qxy the P and Q syndromes of the surviving slots:
+		// D_x ^ D_y = Pxy and g^x*D_x ^ g^y*D_y = Qxy, so
+		// D_x = (g^y*Pxy ^ Qxy) / (g^x ^ g^y) and D_y = Pxy ^ D_x.
+		copy(dy, P)
+		copy(dx, Q)
+		for i, d := range data {
+			if i != x && i != y {
+				xorBlocks(dy, dy, d)
+				gfMulXor(dx, d, gfExp[i])
+			}
+		}
+		c := gfInv(gfExp[x] ^ gfExp[y])
+		gfMulBlock(dx, dx, c)
+		gfMulXor(dx, dy, gfMulTable[c][gfExp[y]])
+		xorBlocks(dy, dy, dx)
+		return nil
+	default:
+		return ErrTooManyFailures
+	}
+}
+
+// RAID 6 (striping with rotating P and Q parity)
+type RAID6 struct {
+	disks   []*Disk
+	mu      sync.Mutex
+	buf     stripeBuffer
+	scratch []int // stripeLayout result, reused under mu
+}
+
+func NewRAID6(disks []*Disk) *RAID6 {
+	return &RAID6{
+		disks:   disks,
+		buf:     newStripeBuffer(len(disks) - 2),
+		scratch: make([]int, 0, len(disks)-2),
+	}
+}
+
+// stripeLayout returns the physical disk of each data slot of a stripe and
+// the indexes of its P and Q disks. Callers must hold mu.
+func (r *RAID6) stripeLayout(stripe int) (slots []int, p, q int) {
+	p = stripe % len(r.disks)
+	q = (p + 1) % len(r.disks)
+	slots = r.scratch[:0]
+	for i := range r.disks {
+		if i != p && i != q {
+			slots = append(slots, i)
+		}
+	}
+	return slots, p, q
+}
+
+// loadStripe reads a stripe's data, P and Q into the supplied buffers,
+// recovering any data slots whose disks are unavailable. P and Q come back
+// recomputed if their own disks were unavailable. Callers must hold mu.
+func (r *RAID6) loadStripe(stripe int, data [][]byte, P, Q []byte) error {
+	slots, p, q := r.stripeLayout(stripe)
+	lost := make([]int, 0, 2)
+	for i, phys := range slots {
+		if !r.disks[phys].Available(stripe) {
+			lost = append(lost, i)
+			continue
+		}
+		if err := r.disks[phys].ReadBlockInto(data[i], stripe); err != nil {
+			return err
+		}
+	}
+	if len(lost) > 2 {
+		return ErrTooManyFailures
+	}
+
+	haveP, haveQ := r.disks[p].Available(stripe), r.disks[q].Available(stripe)
+	if len(lost)+boolToInt(!haveP)+boolToInt(!haveQ) > 2 {
+		return ErrTooManyFailures
+	}
+	var pIn, qIn []byte
+	if haveP {
+		if err := r.disks[p].ReadBlockInto(P, stripe); err != nil {
+			return err
+		}
+		pIn = P
+	}
+	if haveQ {
+		if err := r.disks[q].ReadBlockInto(Q, stripe); err != nil {
+			return err
+		}
+		qIn = Q
+	}
+	if err := recoverData(data, lost, pIn, qIn); err != nil {
+		return err
+	}
+	if !haveP || !haveQ {
+		computePQ(P, Q, data)
+	}
+	return nil
+}
+
+// stripeSlots returns n block slots, backed by small when they fit so that
+// ordinary widths stay on the stack; wider arrays get a heap slice.
+func stripeSlots(small [][]byte, n int) [][]byte {
+	if n <= len(small) {
+		return small[:n]
+	}
+	return make([][]byte, n)
+}
+
+func boolToInt(b bool) int {
+	if b {
+		return 1
+	}
+	return 0
+}
+
+func (r *RAID6) Write(blockNum int, data []byte) error {
+	if len(data) != BlockSize {
+		return fmt.Errorf("data must be exactly %d bytes", BlockSize)
+	}
+	numDataDisks := len(r.disks) - 2
+	stripe := blockNum / numDataDisks
+	indexInStripe := blockNum % numDataDisks
+
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.buf.add(stripe, indexInStripe, data, r.writeStripe)
+}
+
+// writeStripe writes the non-nil blocks of one stripe and updates P and Q.
+// Writing k of n slots costs k+2 reads subtractively (P ^= delta,
+// Q ^= g^i*delta) or n-k reads additively; the cheaper one is used. A
+// degraded stripe is loaded and recovered in full, then rewritten.
+func (r *RAID6) writeStripe(stripe int, blocks [][]byte) error {
+	slots, p, q := r.stripeLayout(stripe)
+	n, k := len(slots), 0
+	for _, b := range blocks {
+		if b != nil {
+			k++
+		}
+	}
+	if k == 0 {
+		return nil
+	}
+	degraded := !r.disks[p].Available(stripe) || !r.disks[q].Available(stripe)
+	for _, phys := range slots {
+		degraded = degraded || !r.disks[phys].Available(stripe)
+	}
+
+	P, Q := getBlock(), getBlock()
+	defer putBlock(P)
+	defer putBlock(Q)
+	if !degraded && k+2 < n-k {
+		// Subtractive (read-modify-write)
+		if err := r.disks[p].ReadBlockInto(P, stripe); err != nil {
+			return err
+		}
+		if err := r.disks[q].ReadBlockInto(Q, stripe); err != nil {
+			return err
+		}
+		delta := getBlock()
+		defer putBlock(delta)
+		for i, b := range blocks {
+			if b == nil {
+				continue
+			}
+			if err := r.disks[slots[i]].ReadBlockInto(delta, stripe); err != nil {
+				return err
+			}
+			xorBlocks(delta, delta, b)
+			xorBlocks(P, P, delta)
+			gfMulXor(Q, delta, gfExp[i])
+		}
+	} else {
+		// Additive (reconstruct-write)
+		var small [16][]byte
+		full := stripeSlots(small[:], n)
+		for i := range full {
+			full[i] = getBlock()
+		}
+		defer putBlocks(full)
+		if degraded {
+			if err := r.loadStripe(stripe, full, P, Q); err != nil {
+				return err
+			}
+			slots, p, q = r.stripeLayout(stripe)
+		} else {
+			for i, b := range blocks {
+				if b != nil {
+					continue
+				}
+				if err := r.disks[slots[i]].ReadBlockInto(full[i], stripe); err != nil {
+					return err
+				}
+			}
+		}
+		for i, b := range blocks {
+			if b != nil {
+				copy(full[i], b)
+			}
+		}
+		computePQ(P, Q, full)
+	}
+
+	for i, b := range blocks {
+		if b == nil || !r.disks[slots[i]].Available(stripe) {
+			continue
+		}
+		if err := r.disks[slots[i]].WriteBlock(stripe, b); err != nil {
+			return err
+		}
+	}
+	if r.disks[p].Available(stripe) {
+		if err := r.disks[p].WriteBlock(stripe, P); err != nil {
+			return err
+		}
+	}
+	if r.disks[q].Available(stripe) {
+		return r.disks[q].WriteBlock(stripe, Q)
+	}
+	return nil
+}
+
+func (r *RAID6) Read(blockNum int) ([]byte, error) {
+	numDataDisks := len(r.disks) - 2
+	stripe := blockNum / numDataDisks
+	indexInStripe := blockNum % numDataDisks
+
+	r.mu.Lock()
+	if b := r.buf.lookup(stripe, indexInStripe); b != nil {
+		out := append([]byte(nil), b...)
+		r.mu.Unlock()
+		return out, nil
+	}
+	slots, _, _ := r.stripeLayout(stripe)
+	disk := r.disks[slots[indexInStripe]]
+	r.mu.Unlock()
+
+	if disk.Available(stripe) {
+		if b, err := disk.ReadBlock(stripe); err != ErrDiskFailed {
+			return b, err
+		}
+	}
+	// Degraded read
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	var small [16][]byte
+	full := stripeSlots(small[:], numDataDisks)
+	for i := range full {
+		full[i] = getBlock()
+	}
+	defer putBlocks(full)
+	P, Q := getBlock(), getBlock()
+	defer putBlock(P)
+	defer putBlock(Q)
+	if err := r.loadStripe(stripe, full, P, Q); err != nil {
+		return nil, err
+	}
+	return append([]byte(nil), full[indexInStripe]...), nil
+}
+
+func (r *RAID6) Flush() error {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	return r.buf.flush(r.writeStripe)
+}
+
+func (r *RAID6) FailDisk(index int) {
+	r.mu.Lock()
+	defer r.mu.Unlock()
+	r.disks[index].Fail()
+}
+
+// Rebuild swaps replacement in for disk index and regenerates its contents
+// in the background at up to rate bytes/sec (0 for unlimited). The returned
+// channel yields the result once all stripes are rebuilt. A second failed
+// disk can be rebuilt alongside or afterwards.
+func (r *RAID6) Rebuild(index int, replacement *Disk, stripes int, rate float64) <-chan error {
+	replacement.valid.Store(0)
+	r.mu.Lock()
+	r.disks[index] = replacement
+	r.mu.Unlock()
+
+	full := make([][]byte, len(r.disks)-2)
+	for i := range full {
+		full[i] = make([]byte, BlockSize)
+	}
+	P, Q := make([]byte, BlockSize), make([]byte, BlockSize)
+	done := make(chan error, 1)
+	go func() {
+		done <- rebuildDisk(&r.mu, replacement, stripes, rate, func(dst []byte, stripe int) error {
+			if err := r.loadStripe(stripe, full, P, Q); err != nil {
+				return err
+			}
+			slots, p, q := r.stripeLayout(stripe)
+			switch index {
+			case p:
+				copy(dst, P)
+			case q:
+				copy(dst, Q)
+			default:
+				for i, phys := range slots {
+					if phys == index {
+						copy(dst, full[i])
+					}
+				}
+			}
+			return nil
+		})
+	}()
+	return done
+}
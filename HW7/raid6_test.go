@@ -0,0 +1,79 @@
+package main
+
+import (
+	"bytes"
+	"crypto/rand"
+	"fmt"
+	"path/filepath"
+	"testing"
+)
+
+func testDisks(t *testing.T, kind string, n int) []*Disk {
+	dir := t.TempDir()
+	disks := make([]*Disk, n)
+	for i := range disks {
+		b, err := OpenBackend(kind, filepath.Join(dir, fmt.Sprintf("disk%d.dat", i)), 64*BlockSize)
+		if err != nil {
+			t.Fatal(err)
+		}
+		disks[i] = NewDiskOn(b)
+		t.Cleanup(func() { disks[i].Close() })
+	}
+	return disks
+}
+
+func checkBlocks(t *testing.T, r RAID, want [][]byte, what string) {
+	t.Helper()
+	for i, w := range want {
+		got, err := r.Read(i)
+		if err != nil {
+			t.Fatalf("%s: block %d: %v", what, i, err)
+		}
+		if !bytes.Equal(got, w) {
+			t.Fatalf("%s: block %d does not match what was written", what, i)
+		}
+	}
+}
+
+// Fail every pair of disks and check that reads recover the original bytes,
+// then rebuild both and check again. P and Q rotate, so across the stripes
+// every pair covers data+data, data+P, data+Q and P+Q. The 20-disk array is
+// wider than the on-stack slot buffers in writeStripe and Read.
+func TestRAID6RoundTrip(t *testing.T) {
+	for _, numDisks := range []int{NumDisks, 20} {
+		t.Run(fmt.Sprintf("%d disks", numDisks), func(t *testing.T) {
+			const stripes = 24
+			disks := testDisks(t, "mem", numDisks)
+			r := NewRAID6(disks)
+			want := make([][]byte, stripes*(numDisks-2))
+			for i := range want {
+				want[i] = make([]byte, BlockSize)
+				rand.Read(want[i])
+				if err := r.Write(i, want[i]); err != nil {
+					t.Fatal(err)
+				}
+			}
+			if err := r.Flush(); err != nil {
+				t.Fatal(err)
+			}
+			checkBlocks(t, r, want, "healthy")
+
+			for a := 0; a < numDisks; a++ {
+				for b := a + 1; b < numDisks; b++ {
+					what := fmt.Sprintf("disks %d and %d", a, b)
+					r.FailDisk(a)
+					r.FailDisk(b)
+					checkBlocks(t, r, want, what+" failed")
+
+					spares := testDisks(t, "mem", 2)
+					for i, index := range []int{a, b} {
+						if err := <-r.Rebuild(index, spares[i], stripes, 0); err != nil {
+							t.Fatalf("%s: rebuild of %d: %v", what, index, err)
+						}
+					}
+					checkBlocks(t, r, want, what+" rebuilt")
+				}
+			}
+		})
+	}
+}
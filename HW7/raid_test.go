@@ -0,0 +1,54 @@
+//go:build !race
+
+// sync.Pool drops items at random under the race detector, so allocation
+// counts are only meaningful without it.
+
+package main
+
+import "testing"
+
+// The parity, reconstruction and recovery paths draw their scratch blocks
+// from blockPool and must not allocate once it is warm.
+func TestParityPathsDoNotAllocate(t *testing.T) {
+	for _, kind := range []string{"file", "mem"} {
+		t.Run(kind, func(t *testing.T) {
+			blocks := make([][]byte, NumDisks)
+			for i := range blocks {
+				blocks[i] = make([]byte, BlockSize)
+			}
+			partial := func(width int) [][]byte { // first two of width slots
+				p := make([][]byte, width)
+				copy(p, blocks[:2])
+				return p
+			}
+			check := func(name string, f func() error) {
+				t.Helper()
+				if err := f(); err != nil {
+					t.Fatalf("%s: %v", name, err)
+				}
+				if n := testing.AllocsPerRun(100, func() { f() }); n != 0 {
+					t.Errorf("%s: %v allocations per call, want 0", name, n)
+				}
+			}
+
+			r5 := NewRAID5(testDisks(t, kind, NumDisks))
+			width := NumDisks - 1
+			p5 := partial(width)
+			check("RAID5 partial-stripe write", func() error { return r5.writeStripe(1, p5) })
+			check("RAID5 full-stripe write", func() error { return r5.writeStripe(2, blocks[:width]) })
+			dst := make([]byte, BlockSize)
+			check("RAID5 reconstruct", func() error { return reconstructBlock(dst, r5.disks, 0, 1) })
+
+			r6 := NewRAID6(testDisks(t, kind, NumDisks))
+			width = NumDisks - 2
+			p6 := partial(width)
+			check("RAID6 partial-stripe write", func() error { return r6.writeStripe(1, p6) })
+			check("RAID6 full-stripe write", func() error { return r6.writeStripe(2, blocks[:width]) })
+			r6.FailDisk(0)
+			r6.FailDisk(1)
+			full := blocks[:width]
+			P, Q := make([]byte, BlockSize), make([]byte, BlockSize)
+			check("RAID6 two-disk recovery", func() error { return r6.loadStripe(1, full, P, Q) })
+		})
+	}
+}
@@ -0,0 +1,217 @@
+package main
+
+import (
+	"errors"
+	"math"
+	"sync"
+	"time"
+)
+
+var ErrTooManyFailures = errors.New("more disks failed than the array can tolerate")
+
+// stripeBuffer holds writes to a single open stripe so sequential writes
+// can be coalesced into full-stripe writes that need no reads at all.
+type stripeBuffer struct {
+	stripe int      // open stripe, -1 if none
+	blocks [][]byte // pending data per data slot, nil if untouched
+	count  int      // number of non-nil entries in blocks
+}
+
+func newStripeBuffer(width int) stripeBuffer {
+	return stripeBuffer{stripe: -1, blocks: make([][]byte, width)}
+}
+
+// add buffers data for the given stripe slot. Writing to a different stripe
+// flushes the open one first, and a stripe is flushed as soon as it is full.
+func (s *stripeBuffer) add(stripe, slot int, data []byte, flush func(stripe int, blocks [][]byte) error) error {
+	if s.stripe != stripe {
+		if err := s.flush(flush); err != nil {
+			return err
+		}
+		s.stripe = stripe
+	}
+	if s.blocks[slot] == nil {
+		s.count++
+		s.blocks[slot] = getBlock()
+	}
+	copy(s.blocks[slot], data)
+	if s.count == len(s.blocks) {
+		return s.flush(flush)
+	}
+	return nil
+}
+
+// lookup returns the buffered block for a stripe slot, or nil.
+func (s *stripeBuffer) lookup(stripe, slot int) []byte {
+	if s.stripe != stripe {
+		return nil
+	}
+	return s.blocks[slot]
+}
+
+// flush writes out the open stripe, if any.
+func (s *stripeBuffer) flush(flush func(stripe int, blocks [][]byte) error) error {
+	if s.stripe < 0 {
+		return nil
+	}
+	err := flush(s.stripe, s.blocks)
+	for i, b := range s.blocks {
+		if b != nil {
+			putBlock(b)
+			s.blocks[i] = nil
+		}
+	}
+	s.stripe, s.count = -1, 0
+	return err
+}
+
+// writeStripe writes the non-nil blocks of one stripe and updates its parity.
+// data holds the stripe's data disks in slot order. With k of n slots being
+// written, subtractive parity (P' = P ^ D_old ^ D_new) costs k+1 reads while
+// additive parity (XOR of the whole stripe) costs n-k reads; the cheaper one
+// is used, so a full stripe is written without any reads.
+//
+// With one member unavailable the method is forced instead: a missing written
+// slot can only be folded in additively, a missing untouched slot only
+// subtractively, and a missing parity disk just gets skipped.
+func writeStripe(data []*Disk, parityDisk *Disk, diskBlock int, blocks [][]byte) error {
+	n, k := len(data), 0
+	for _, b := range blocks {
+		if b != nil {
+			k++
+		}
+	}
+	if k == 0 {
+		return nil
+	}
+
+	missing := -1 // slot of the unavailable member, n for parity
+	for i, d := range data {
+		if !d.Available(diskBlock) {
+			if missing >= 0 {
+				return ErrTooManyFailures
+			}
+			missing = i
+		}
+	}
+	if !parityDisk.Available(diskBlock) {
+		if missing >= 0 {
+			return ErrTooManyFailures
+		}
+		missing = n
+	}
+
+	subtractive := k+1 < n-k
+	if missing >= 0 && missing < n {
+		subtractive = blocks[missing] == nil
+	}
+
+	parity := getBlock()
+	defer putBlock(parity)
+	if missing == n {
+		// No parity to maintain
+	} else if subtractive {
+		// Subtractive (read-modify-write)
+		if err := parityDisk.ReadBlockInto(parity, diskBlock); err != nil {
+			return err
+		}
+		scratch := getBlock()
+		defer putBlock(scratch)
+		for i, b := range blocks {
+			if b == nil {
+				continue
+			}
+			old, err := data[i].peekBlock(scratch, diskBlock)
+			if err != nil {
+				return err
+			}
+			xorBlocks(parity, parity, old, b)
+		}
+	} else {
+		// Additive (reconstruct-write)
+		srcs := make([][]byte, 0, 16)
+		scratch := make([][]byte, 0, 16)
+		defer func() { putBlocks(scratch) }()
+		for i, b := range blocks {
+			if b == nil {
+				scratch = append(scratch, getBlock())
+				old, err := data[i].peekBlock(scratch[len(scratch)-1], diskBlock)
+				if err != nil {
+					return err
+				}
+				b = old
+			}
+			srcs = append(srcs, b)
+		}
+		xorBlocks(parity, srcs...)
+	}
+
+	for i, b := range blocks {
+		if b == nil || i == missing {
+			continue
+		}
+		if err := data[i].WriteBlock(diskBlock, b); err != nil {
+			return err
+		}
+	}
+	if missing == n {
+		return nil
+	}
+	return parityDisk.WriteBlock(diskBlock, parity)
+}
+
+// reconstructBlock rebuilds members[missing] for one stripe into dst by
+// XOR-ing every other member, data and parity alike.
+func reconstructBlock(dst []byte, members []*Disk, missing, diskBlock int) error {
+	b := getBlock()
+	defer putBlock(b)
+	clear(dst)
+	for i, d := range members {
+		if i == missing {
+			continue
+		}
+		if !d.Available(diskBlock) {
+			return ErrTooManyFailures
+		}
+		src, err := d.peekBlock(b, diskBlock)
+		if err != nil {
+			return err
+		}
+		xorBlocks(dst, dst, src)
+	}
+	return nil
+}
+
+// rebuildDisk fills the replacement disk for stripes [0, stripes), using
+// regenerate to compute its block of each stripe. Each stripe is done under
+// mu so foreground I/O interleaves with the rebuild, and the replacement's
+// valid watermark advances as it goes. rate caps the rebuild in bytes per
+// second; 0 means unlimited.
+func rebuildDisk(mu *sync.Mutex, replacement *Disk, stripes int, rate float64, regenerate func(dst []byte, stripe int) error) error {
+	block := getBlock()
+	defer putBlock(block)
+	start := time.Now()
+	for stripe := 0; stripe < stripes; stripe++ {
+		mu.Lock()
+		err := regenerate(block, stripe)
+		if err == nil {
+			err = replacement.WriteBlock(stripe, block)
+		}
+		if err == nil {
+			replacement.valid.Store(int64(stripe + 1))
+		}
+		mu.Unlock()
+		if err != nil {
+			return err
+		}
+
+		if rate > 0 {
+			due := time.Duration(float64((stripe+1)*BlockSize) / rate * float64(time.Second))
+			if wait := due - time.Since(start); wait > 0 {
+				time.Sleep(wait)
+			}
+		}
+	}
+	replacement.valid.Store(math.MaxInt64)
+	return nil
+}
@@ -0,0 +1,224 @@
+package main
+
+import (
+	"crypto/rand"
+	"encoding/json"
+	"fmt"
+	mrand "math/rand"
+	"os"
+	"sort"
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+type Pattern int
+
+const (
+	Sequential Pattern = iota // each client streams through its own region
+	Random                    // uniform over the address space
+	Zipfian                   // skewed towards low block numbers
+)
+
+func (p Pattern) String() string {
+	return [...]string{"sequential", "random", "zipfian"}[p]
+}
+
+// ZipfSkew is the Zipf s parameter; larger is more skewed (must be > 1).
+const ZipfSkew = 1.1
+
+// Workload describes a mixed I/O load against one array.
+type Workload struct {
+	Name        string
+	Clients     int     // concurrent clients
+	QueueDepth  int     // outstanding I/Os per client
+	Pattern     Pattern // how block addresses are chosen
+	ReadPct     int     // percentage of operations that are reads
+	BlocksPerIO int     // I/O size as a multiple of BlockSize
+	Ops         int     // total I/Os across all clients
+	Blocks      int     // address space in blocks
+}
+
+// WorkloadResult is one JSON line of benchmark output.
+type WorkloadResult struct {
+	RAID       string  `json:"raid"`
+	Workload   string  `json:"workload"`
+	Pattern    string  `json:"pattern"`
+	Clients    int     `json:"clients"`
+	QueueDepth int     `json:"queue_depth"`
+	ReadPct    int     `json:"read_pct"`
+	IOBytes    int     `json:"io_bytes"`
+	Ops        int     `json:"ops"`
+	Errors     int64   `json:"errors"`
+	Seconds    float64 `json:"seconds"`
+	IOPS       float64 `json:"iops"`
+	MBps       float64 `json:"mb_per_sec"`
+	P50us      float64 `json:"p50_us"`
+	P99us      float64 `json:"p99_us"`
+	P999us     float64 `json:"p999_us"`
+}
+
+// runWorkload drives raid with w.Clients*w.QueueDepth goroutines. Each one
+// keeps its own RNG and latency log, so the hot loop shares nothing but the
+// op counter and the progress counter.
+func runWorkload(raidName string, raid RAID, w Workload) WorkloadResult {
+	ios := w.Blocks / w.BlocksPerIO // addressable I/O slots
+	workers := w.Clients * w.QueueDepth
+	var issued, done, errs atomic.Int64
+	latencies := make([][]time.Duration, workers)
+
+	// Sequential streams: one cursor per client, shared by its queue
+	cursors := make([]atomic.Int64, w.Clients)
+	for c := range cursors {
+		cursors[c].Store(int64(c * ios / w.Clients))
+	}
+
+	stopProgress := startProgress(raidName+" "+w.Name, &done, w.Ops)
+	var wg sync.WaitGroup
+	start := time.Now()
+	for i := 0; i < workers; i++ {
+		wg.Add(1)
+		go func(worker int) {
+			defer wg.Done()
+			client := worker / w.QueueDepth
+			rng := mrand.New(mrand.NewSource(time.Now().UnixNano() + int64(worker)))
+			var zipf *mrand.Zipf
+			if w.Pattern == Zipfian {
+				zipf = mrand.NewZipf(rng, ZipfSkew, 1, uint64(ios-1))
+			}
+			buf := make([]byte, w.BlocksPerIO*BlockSize)
+			rand.Read(buf)
+			lat := make([]time.Duration, 0, w.Ops/workers+1)
+
+			for issued.Add(1) <= int64(w.Ops) {
+				var slot int
+				switch w.Pattern {
+				case Sequential:
+					slot = int((cursors[client].Add(1) - 1) % int64(ios))
+				case Random:
+					slot = rng.Intn(ios)
+				case Zipfian:
+					slot = int(zipf.Uint64())
+				}
+				first := slot * w.BlocksPerIO
+				isRead := rng.Intn(100) < w.ReadPct
+
+				opStart := time.Now()
+				for b := 0; b < w.BlocksPerIO; b++ {
+					var err error
+					if isRead {
+						_, err = raid.Read(first + b)
+					} else {
+						err = raid.Write(first+b, buf[b*BlockSize:(b+1)*BlockSize])
+					}
+					if err != nil {
+						errs.Add(1)
+						break
+					}
+				}
+				lat = append(lat, time.Since(opStart))
+				done.Add(1)
+			}
+			latencies[worker] = lat
+		}(i)
+	}
+	wg.Wait()
+	if err := raid.Flush(); err != nil {
+		errs.Add(1)
+	}
+	elapsed := time.Since(start)
+	stopProgress()
+
+	var all []time.Duration
+	for _, lat := range latencies {
+		all = append(all, lat...)
+	}
+	sort.Slice(all, func(i, j int) bool { return all[i] < all[j] })
+	percentile := func(p float64) float64 {
+		if len(all) == 0 {
+			return 0
+		}
+		idx := int(p*float64(len(all))+0.5) - 1
+		idx = min(max(idx, 0), len(all)-1)
+		return float64(all[idx].Nanoseconds()) / 1e3
+	}
+
+	return WorkloadResult{
+		RAID:       raidName,
+		Workload:   w.Name,
+		Pattern:    w.Pattern.String(),
+		Clients:    w.Clients,
+		QueueDepth: w.QueueDepth,
+		ReadPct:    w.ReadPct,
+		IOBytes:    w.BlocksPerIO * BlockSize,
+		Ops:        w.Ops,
+		Errors:     errs.Load(),
+		Seconds:    elapsed.Seconds(),
+		IOPS:       float64(w.Ops) / elapsed.Seconds(),
+		MBps:       float64(w.Ops*w.BlocksPerIO*BlockSize) / (1024 * 1024) / elapsed.Seconds(),
+		P50us:      percentile(0.50),
+		P99us:      percentile(0.99),
+		P999us:     percentile(0.999),
+	}
+}
+
+// startProgress reports done/total on stderr from its own goroutine, so the
+// I/O loop only bumps an atomic counter. The returned func stops it.
+func startProgress(label string, done *atomic.Int64, total int) func() {
+	stop := make(chan struct{})
+	finished := make(chan struct{})
+	report := func() {
+		fmt.Fprintf(os.Stderr, "\r%s Progress: %.2f%%", label, 100*float64(done.Load())/float64(total))
+	}
+	go func() {
+		defer close(finished)
+		ticker := time.NewTicker(250 * time.Millisecond)
+		defer ticker.Stop()
+		for {
+			select {
+			case <-ticker.C:
+				report()
+			case <-stop:
+				report()
+				fmt.Fprintln(os.Stderr)
+				return
+			}
+		}
+	}()
+	return func() {
+		close(stop)
+		<-finished
+	}
+}
+
+// prefill writes every block sequentially, in full stripes, so workload
+// reads hit written data rather than holes that read back as zeros.
+func prefill(raid RAID, blocks int) error {
+	buf := make([]byte, BlockSize)
+	for i := 0; i < blocks; i++ {
+		rand.Read(buf)
+		if err := raid.Write(i, buf); err != nil {
+			return err
+		}
+	}
+	return raid.Flush()
+}
+
+// run every workload against one array and print a JSON line per result
+func benchmarkWorkloads(name string, raid RAID, workloads []Workload) {
+	blocks := 0
+	for _, w := range workloads {
+		blocks = max(blocks, w.Blocks)
+	}
+	if err := prefill(raid, blocks); err != nil {
+		fmt.Printf("Prefill error: %v\n", err)
+		return
+	}
+	enc := json.NewEncoder(os.Stdout)
+	for _, w := range workloads {
+		if err := enc.Encode(runWorkload(name, raid, w)); err != nil {
+			fmt.Printf("Encode error: %v\n", err)
+			return
+		}
+	}
+}